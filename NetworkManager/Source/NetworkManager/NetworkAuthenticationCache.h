@@ -0,0 +1,104 @@
+//
+//  NetworkAuthenticationCache.h
+//
+//  Created by agent on 10/19/26.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+//  This work is licensed under a Creative Commons Attribution-ShareAlike 4.0 International License.
+//  http://creativecommons.org/licenses/by-sa/4.0/
+
+#import <Foundation/Foundation.h>
+
+/** Cache of authentication challenge decisions.
+
+ When assigned to the `authenticationCache` property of a `<NetworkManager>`, the manager consults the cache before
+ calling any challenge handler. On a hit, the challenge is answered right away on the session's delegate queue,
+ without the round trip to the `completionQueue` (which is the main queue by default). On a miss, the handler is called
+ as usual, and the decision it makes is cached.
+
+ Decisions are keyed by the protection space (host, port, protocol, realm, authentication method and whether it is a proxy).
+ Server trust decisions are also keyed by the server's leaf certificate, so a decision to trust one certificate is
+ never applied to another one. Each decision expires after `<serverTrustLifetime>` or `<credentialLifetime>`.
+
+ For server trust, the outcome of the handler's own evaluation (e.g. certificate pinning, or accepting a self-signed
+ certificate) is reused as is, without evaluating the trust again, for as long as the server presents the same leaf
+ certificate. So a certificate that expires or is revoked is still trusted until the decision expires.
+
+ Decisions to cancel the challenge are not cached. A cached decision is discarded, and the handler called again,
+ if the challenge indicates that it failed (i.e. its `previousFailureCount` is non-zero).
+
+ @note Because decisions are keyed by protection space, not by task, a decision made by one operation's
+       `didReceiveChallengeHandler` (or the manager's `didReceiveChallenge`) applies to every operation whose
+       challenge has the same protection space, and those operations' own handlers are not called. This goes for
+       server trust, too: a certificate one operation's handler accepted is accepted for every other operation.
+       If different operations need different credentials, or different trust policies, for the same protection
+       space, don't use a cache.
+ */
+
+@interface NetworkAuthenticationCache : NSObject
+
+/// ----------------
+/// @name Properties
+/// ----------------
+
+/// The number of seconds a server trust decision is cached. Default is 10 minutes.
+
+@property (nonatomic) NSTimeInterval serverTrustLifetime;
+
+/// The number of seconds any other decision (e.g. a Basic, Digest or NTLM credential) is cached. Default is 5 minutes.
+
+@property (nonatomic) NSTimeInterval credentialLifetime;
+
+/// The number of challenges answered from the cache.
+
+@property (readonly) NSUInteger hitCount;
+
+/// The number of challenges for which no decision was cached.
+
+@property (readonly) NSUInteger missCount;
+
+/// ------------------
+/// @name Lookup
+/// ------------------
+
+/** Retrieve the cached decision for a challenge.
+ *
+ * @param disposition If there is a decision, this will be set to its disposition.
+ * @param credential  If there is a decision, this will be set to its credential (if any). For server trust, this is a credential for the challenge's own trust.
+ * @param challenge   The authentication challenge.
+ *
+ * @return `YES` if there was a decision. `NO` if the handler must be called.
+ */
+
+- (BOOL)getDisposition:(NSURLSessionAuthChallengeDisposition *)disposition
+            credential:(NSURLCredential **)credential
+          forChallenge:(NSURLAuthenticationChallenge *)challenge;
+
+/** Cache the decision for a challenge.
+ *
+ * @param disposition The disposition with which the challenge was answered.
+ * @param credential  The credential with which the challenge was answered, if any.
+ * @param challenge   The authentication challenge.
+ */
+
+- (void)storeDisposition:(NSURLSessionAuthChallengeDisposition)disposition
+              credential:(NSURLCredential *)credential
+            forChallenge:(NSURLAuthenticationChallenge *)challenge;
+
+/// ------------------
+/// @name Invalidation
+/// ------------------
+
+/** Discard the cached decisions for a host (e.g. when the user logs out).
+ *
+ * @param host The host name.
+ */
+
+- (void)removeDecisionsForHost:(NSString *)host;
+
+/** Discard all cached decisions.
+ */
+
+- (void)removeAllDecisions;
+
+@end
@@ -0,0 +1,186 @@
+//
+//  NetworkAuthenticationCache.m
+//
+//  Created by agent on 10/19/26.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+//  This work is licensed under a Creative Commons Attribution-ShareAlike 4.0 International License.
+//  http://creativecommons.org/licenses/by-sa/4.0/
+
+#import "NetworkAuthenticationCache.h"
+#import <CommonCrypto/CommonDigest.h>
+
+@import Security;
+
+/** A single cached decision.
+ */
+@interface NetworkAuthenticationDecision : NSObject
+@property (nonatomic) NSURLSessionAuthChallengeDisposition disposition;
+@property (nonatomic, strong) NSURLCredential *credential;
+@property (nonatomic, copy) NSString *host;
+@property (nonatomic) CFAbsoluteTime expirationTime;
+@end
+
+@implementation NetworkAuthenticationDecision
+@end
+
+
+@interface NetworkAuthenticationCache ()
+
+@property (nonatomic, strong) NSMutableDictionary *decisions;
+@property (readwrite) NSUInteger hitCount;
+@property (readwrite) NSUInteger missCount;
+
+@end
+
+@implementation NetworkAuthenticationCache
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        _decisions = [[NSMutableDictionary alloc] init];
+        _serverTrustLifetime = 10.0 * 60.0;
+        _credentialLifetime = 5.0 * 60.0;
+    }
+    return self;
+}
+
+#pragma mark - Keys
+
+- (BOOL)isServerTrustChallenge:(NSURLAuthenticationChallenge *)challenge {
+    return [challenge.protectionSpace.authenticationMethod isEqualToString:NSURLAuthenticationMethodServerTrust];
+}
+
+/* The SHA-256 of the server's leaf certificate, or `nil` if there isn't one.
+ */
+- (NSString *)leafCertificateDigestForTrust:(SecTrustRef)trust {
+    if (!trust || SecTrustGetCertificateCount(trust) == 0)
+        return nil;
+
+    NSData *certificateData = CFBridgingRelease(SecCertificateCopyData(SecTrustGetCertificateAtIndex(trust, 0)));
+    if (!certificateData)
+        return nil;
+
+    unsigned char digest[CC_SHA256_DIGEST_LENGTH];
+    CC_SHA256([certificateData bytes], (CC_LONG)[certificateData length], digest);
+
+    NSMutableString *string = [NSMutableString stringWithCapacity:CC_SHA256_DIGEST_LENGTH * 2];
+    for (NSInteger i = 0; i < CC_SHA256_DIGEST_LENGTH; i++) {
+        [string appendFormat:@"%02x", digest[i]];
+    }
+    return string;
+}
+
+- (NSString *)keyForChallenge:(NSURLAuthenticationChallenge *)challenge {
+    NSURLProtectionSpace *protectionSpace = challenge.protectionSpace;
+    NSString *certificate = @"";
+
+    if ([self isServerTrustChallenge:challenge]) {
+        certificate = [self leafCertificateDigestForTrust:protectionSpace.serverTrust];
+        if (!certificate)
+            return nil;
+    }
+
+    return [NSString stringWithFormat:@"%@|%@|%@|%ld|%@|%d|%@",
+            protectionSpace.authenticationMethod,
+            protectionSpace.protocol ?: @"",
+            [protectionSpace.host lowercaseString] ?: @"",
+            (long)protectionSpace.port,
+            protectionSpace.realm ?: @"",
+            [protectionSpace isProxy],
+            certificate];
+}
+
+#pragma mark - Lookup
+
+- (BOOL)getDisposition:(NSURLSessionAuthChallengeDisposition *)disposition
+            credential:(NSURLCredential **)credential
+          forChallenge:(NSURLAuthenticationChallenge *)challenge {
+    NSString *key = [self keyForChallenge:challenge];
+    NetworkAuthenticationDecision *decision;
+
+    @synchronized(self) {
+        decision = key ? self.decisions[key] : nil;
+
+        // a decision that has expired, or that the server has just rejected, is no good
+
+        if (decision && (challenge.previousFailureCount > 0 || CFAbsoluteTimeGetCurrent() >= decision.expirationTime)) {
+            [self.decisions removeObjectForKey:key];
+            decision = nil;
+        }
+    }
+
+    @synchronized(self) {
+        if (decision)
+            self.hitCount++;
+        else
+            self.missCount++;
+    }
+
+    if (!decision)
+        return NO;
+
+    if (disposition)
+        *disposition = decision.disposition;
+
+    if (credential) {
+        // a server trust credential is bound to a particular trust object, so create one for this challenge's trust
+
+        if ([self isServerTrustChallenge:challenge] && decision.disposition == NSURLSessionAuthChallengeUseCredential)
+            *credential = [NSURLCredential credentialForTrust:challenge.protectionSpace.serverTrust];
+        else
+            *credential = decision.credential;
+    }
+
+    return YES;
+}
+
+- (void)storeDisposition:(NSURLSessionAuthChallengeDisposition)disposition
+              credential:(NSURLCredential *)credential
+            forChallenge:(NSURLAuthenticationChallenge *)challenge {
+    if (disposition == NSURLSessionAuthChallengeCancelAuthenticationChallenge)
+        return;
+
+    NSString *key = [self keyForChallenge:challenge];
+    if (!key)
+        return;
+
+    NSTimeInterval lifetime = [self isServerTrustChallenge:challenge] ? self.serverTrustLifetime : self.credentialLifetime;
+    if (lifetime <= 0)
+        return;
+
+    // for server trust, the key includes the leaf certificate, so a hit is for the very certificate the handler
+    // decided on. Only the outcome is kept, not the credential (which is bound to this challenge's trust object);
+    // a credential for the next challenge's own trust is created on a hit
+
+    NetworkAuthenticationDecision *decision = [[NetworkAuthenticationDecision alloc] init];
+    decision.disposition = disposition;
+    decision.credential = [self isServerTrustChallenge:challenge] ? nil : credential;
+    decision.host = [challenge.protectionSpace.host lowercaseString];
+    decision.expirationTime = CFAbsoluteTimeGetCurrent() + lifetime;
+
+    @synchronized(self) {
+        self.decisions[key] = decision;
+    }
+}
+
+#pragma mark - Invalidation
+
+- (void)removeDecisionsForHost:(NSString *)host {
+    NSString *lowercaseHost = [host lowercaseString];
+
+    @synchronized(self) {
+        NSSet *keys = [self.decisions keysOfEntriesPassingTest:^BOOL(NSString *key, NetworkAuthenticationDecision *decision, BOOL *stop) {
+            return [decision.host isEqualToString:lowercaseHost];
+        }];
+        [self.decisions removeObjectsForKeys:[keys allObjects]];
+    }
+}
+
+- (void)removeAllDecisions {
+    @synchronized(self) {
+        [self.decisions removeAllObjects];
+    }
+}
+
+@end
@@ -0,0 +1,96 @@
+//
+//  NetworkBatchEnvelope.h
+//
+//  Created by agent on 10/19/26.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+//  This work is licensed under a Creative Commons Attribution-ShareAlike 4.0 International License.
+//  http://creativecommons.org/licenses/by-sa/4.0/
+
+#import <Foundation/Foundation.h>
+
+extern NSString * const kNetworkBatchEnvelopeErrorDomain;
+
+typedef NS_ENUM(NSInteger, NetworkBatchEnvelopeErrorCode) {
+    NetworkBatchEnvelopeErrorCodeMalformedResponse = 1,
+    NetworkBatchEnvelopeErrorCodeMissingResponse   = 2
+};
+
+/** The response to one of the requests in a batch.
+ */
+@interface NetworkBatchItemResponse : NSObject
+
+/// The response to the request, as if it had been sent by itself.
+
+@property (nonatomic, strong) NSHTTPURLResponse *response;
+
+/// The body of the response.
+
+@property (nonatomic, strong) NSData *data;
+
+@end
+
+/** The format in which a batch of requests is sent, and in which its responses are returned.
+
+ `<NetworkRequestBatcher>` uses an envelope to combine several requests into a single request to the server's batch
+ endpoint, and to split that request's response back into a response for each of them. To talk to a server
+ (or local stand-in server) with a different batch format, implement this protocol.
+ */
+@protocol NetworkBatchEnvelope <NSObject>
+
+/** Create the batch request.
+ *
+ * @param url      The URL of the batch endpoint.
+ * @param requests An array of the `NSURLRequest` objects to be combined. These all have the same origin as `url`.
+ *
+ * @return         The request to send, or `nil` if the requests can't be combined.
+ */
+
+- (NSURLRequest *)batchRequestWithURL:(NSURL *)url requests:(NSArray *)requests;
+
+/** Split the batch response.
+ *
+ * @param data     The body of the batch response.
+ * @param response The batch response.
+ * @param requests The array of `NSURLRequest` objects that were combined.
+ * @param error    If the batch response could not be parsed, this will be set to the error.
+ *
+ * @return         An array with one object for each request, in the same order: either a `NetworkBatchItemResponse`,
+ *                 or an `NSError` if there was no response for it. Returns `nil` if the batch response could not be parsed.
+ */
+
+- (NSArray *)itemResponsesWithData:(NSData *)data
+                          response:(NSHTTPURLResponse *)response
+                          requests:(NSArray *)requests
+                             error:(NSError **)error;
+
+@end
+
+/** JSON array batch envelope.
+
+ The batch request is a `POST` of `application/json`, whose body is an array with an object for each request:
+
+     [{"id": "0", "method": "POST", "path": "/api/like?id=1", "headers": {"Content-Type": "application/x-www-form-urlencoded"}, "body": "value=1"}, ...]
+
+ (A body that isn't valid UTF-8 is base64 encoded, and the object has `"encoding": "base64"`.)
+
+ The response must be a JSON array with an object for each request, with the matching `id` (or, absent an `id`, in the same order):
+
+     [{"id": "0", "status": 200, "headers": {"Content-Type": "application/json"}, "body": {"liked": true}}, ...]
+
+ where `body` is either a string or a JSON object (which is passed on as its JSON representation).
+ */
+@interface NetworkJSONBatchEnvelope : NSObject <NetworkBatchEnvelope>
+@end
+
+/** `multipart/mixed` batch envelope.
+
+ The batch request is a `POST` of `multipart/mixed`, with an `application/http` part for each request, identified
+ by a `Content-ID` of `<item-N>`, whose body is the request in HTTP/1.1 format.
+
+ The response must be `multipart/mixed`, with an `application/http` part for each request, identified by a
+ `Content-ID` of `<response-item-N>` (or, absent a `Content-ID`, in the same order), whose body is the response
+ in HTTP/1.1 format. This is the batch format used by a number of Google APIs.
+ */
+@interface NetworkMultipartBatchEnvelope : NSObject <NetworkBatchEnvelope>
+@end
@@ -0,0 +1,324 @@
+//
+//  NetworkBatchEnvelope.m
+//
+//  Created by agent on 10/19/26.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+//  This work is licensed under a Creative Commons Attribution-ShareAlike 4.0 International License.
+//  http://creativecommons.org/licenses/by-sa/4.0/
+
+#import "NetworkBatchEnvelope.h"
+
+NSString * const kNetworkBatchEnvelopeErrorDomain = @"NetworkBatchEnvelope";
+
+/* The path (and query, if any) of a URL, still percent encoded, as it would appear in an HTTP request line.
+ */
+static NSString *NetworkBatchRequestPath(NSURL *url) {
+    NSURLComponents *components = [NSURLComponents componentsWithURL:url resolvingAgainstBaseURL:YES];
+    NSString *path = [components.percentEncodedPath length] ? components.percentEncodedPath : @"/";
+
+    return components.percentEncodedQuery ? [NSString stringWithFormat:@"%@?%@", path, components.percentEncodedQuery] : path;
+}
+
+static NSError *NetworkBatchError(NetworkBatchEnvelopeErrorCode code, NSURL *url, NSString *description) {
+    NSMutableDictionary *userInfo = [NSMutableDictionary dictionaryWithObject:description forKey:NSLocalizedDescriptionKey];
+    if (url)
+        userInfo[NSURLErrorKey] = url;
+
+    return [NSError errorWithDomain:kNetworkBatchEnvelopeErrorDomain code:code userInfo:userInfo];
+}
+
+/* An array with a "missing response" error for each request, to be replaced by the responses that are found.
+ */
+static NSMutableArray *NetworkBatchMissingResponses(NSArray *requests) {
+    NSMutableArray *results = [NSMutableArray arrayWithCapacity:[requests count]];
+    for (NSURLRequest *request in requests) {
+        [results addObject:NetworkBatchError(NetworkBatchEnvelopeErrorCodeMissingResponse, request.URL, @"No response to request in batch")];
+    }
+    return results;
+}
+
+@implementation NetworkBatchItemResponse
+@end
+
+#pragma mark - JSON
+
+@implementation NetworkJSONBatchEnvelope
+
+- (NSURLRequest *)batchRequestWithURL:(NSURL *)url requests:(NSArray *)requests {
+    NSMutableArray *items = [NSMutableArray arrayWithCapacity:[requests count]];
+
+    [requests enumerateObjectsUsingBlock:^(NSURLRequest *request, NSUInteger idx, BOOL *stop) {
+        NSMutableDictionary *item = [NSMutableDictionary dictionary];
+        item[@"id"] = [@(idx) stringValue];
+        item[@"method"] = request.HTTPMethod ?: @"GET";
+        item[@"path"] = NetworkBatchRequestPath(request.URL);
+        if ([request.allHTTPHeaderFields count])
+            item[@"headers"] = request.allHTTPHeaderFields;
+
+        if (request.HTTPBody) {
+            NSString *body = [[NSString alloc] initWithData:request.HTTPBody encoding:NSUTF8StringEncoding];
+            if (body) {
+                item[@"body"] = body;
+            } else {
+                item[@"body"] = [request.HTTPBody base64EncodedStringWithOptions:0];
+                item[@"encoding"] = @"base64";
+            }
+        }
+
+        [items addObject:item];
+    }];
+
+    NSData *body = [NSJSONSerialization dataWithJSONObject:items options:0 error:nil];
+    if (!body)
+        return nil;
+
+    NSMutableURLRequest *batchRequest = [[NSMutableURLRequest alloc] initWithURL:url];
+    [batchRequest setCachePolicy:NSURLRequestReloadIgnoringLocalCacheData];
+    [batchRequest setHTTPMethod:@"POST"];
+    [batchRequest setValue:@"application/json" forHTTPHeaderField:@"Content-Type"];
+    [batchRequest setValue:@"application/json" forHTTPHeaderField:@"Accept"];
+    [batchRequest setHTTPBody:body];
+
+    return batchRequest;
+}
+
+- (NSArray *)itemResponsesWithData:(NSData *)data
+                          response:(NSHTTPURLResponse *)response
+                          requests:(NSArray *)requests
+                             error:(NSError **)error {
+    id items = data ? [NSJSONSerialization JSONObjectWithData:data options:0 error:nil] : nil;
+
+    if (![items isKindOfClass:[NSArray class]]) {
+        if (error)
+            *error = NetworkBatchError(NetworkBatchEnvelopeErrorCodeMalformedResponse, response.URL, @"Batch response is not a JSON array");
+        return nil;
+    }
+
+    NSMutableArray *results = NetworkBatchMissingResponses(requests);
+
+    [items enumerateObjectsUsingBlock:^(NSDictionary *item, NSUInteger idx, BOOL *stop) {
+        if (![item isKindOfClass:[NSDictionary class]])
+            return;
+
+        id identifier = item[@"id"];
+        NSInteger index = [identifier respondsToSelector:@selector(integerValue)] ? [identifier integerValue] : (NSInteger)idx;
+        if (index < 0 || index >= (NSInteger)[requests count])
+            return;
+
+        NSURLRequest *request = requests[index];
+        NSDictionary *headers = [item[@"headers"] isKindOfClass:[NSDictionary class]] ? item[@"headers"] : nil;
+
+        NetworkBatchItemResponse *itemResponse = [[NetworkBatchItemResponse alloc] init];
+        itemResponse.response = [[NSHTTPURLResponse alloc] initWithURL:request.URL statusCode:[item[@"status"] integerValue] HTTPVersion:@"HTTP/1.1" headerFields:headers];
+        itemResponse.data = [self dataForBody:item[@"body"] encoding:item[@"encoding"]];
+
+        results[index] = itemResponse;
+    }];
+
+    return results;
+}
+
+- (NSData *)dataForBody:(id)body encoding:(NSString *)encoding {
+    if ([body isKindOfClass:[NSString class]]) {
+        if ([encoding isEqual:@"base64"])
+            return [[NSData alloc] initWithBase64EncodedString:body options:0];
+        return [body dataUsingEncoding:NSUTF8StringEncoding];
+    }
+
+    if ([body isKindOfClass:[NSDictionary class]] || [body isKindOfClass:[NSArray class]])
+        return [NSJSONSerialization dataWithJSONObject:body options:0 error:nil];
+
+    return [NSData data];
+}
+
+@end
+
+#pragma mark - multipart/mixed
+
+@implementation NetworkMultipartBatchEnvelope
+
+- (NSURLRequest *)batchRequestWithURL:(NSURL *)url requests:(NSArray *)requests {
+    NSString *boundary = [NSString stringWithFormat:@"batch-%@", [[NSUUID UUID] UUIDString]];
+    NSMutableData *body = [NSMutableData data];
+
+    [requests enumerateObjectsUsingBlock:^(NSURLRequest *request, NSUInteger idx, BOOL *stop) {
+        NSMutableString *head = [NSMutableString string];
+
+        [head appendFormat:@"--%@\r\n", boundary];
+        [head appendString:@"Content-Type: application/http\r\n"];
+        [head appendFormat:@"Content-ID: <item-%lu>\r\n\r\n", (unsigned long)idx];
+
+        [head appendFormat:@"%@ %@ HTTP/1.1\r\n", request.HTTPMethod ?: @"GET", NetworkBatchRequestPath(request.URL)];
+        [head appendFormat:@"Host: %@\r\n", request.URL.host];
+        [request.allHTTPHeaderFields enumerateKeysAndObjectsUsingBlock:^(NSString *key, NSString *value, BOOL *stop) {
+            [head appendFormat:@"%@: %@\r\n", key, value];
+        }];
+        if (request.HTTPBody && ![request valueForHTTPHeaderField:@"Content-Length"])
+            [head appendFormat:@"Content-Length: %lu\r\n", (unsigned long)[request.HTTPBody length]];
+        [head appendString:@"\r\n"];
+
+        [body appendData:[head dataUsingEncoding:NSUTF8StringEncoding]];
+        if (request.HTTPBody)
+            [body appendData:request.HTTPBody];
+        [body appendData:[@"\r\n" dataUsingEncoding:NSUTF8StringEncoding]];
+    }];
+
+    [body appendData:[[NSString stringWithFormat:@"--%@--\r\n", boundary] dataUsingEncoding:NSUTF8StringEncoding]];
+
+    NSMutableURLRequest *batchRequest = [[NSMutableURLRequest alloc] initWithURL:url];
+    [batchRequest setCachePolicy:NSURLRequestReloadIgnoringLocalCacheData];
+    [batchRequest setHTTPMethod:@"POST"];
+    [batchRequest setValue:[NSString stringWithFormat:@"multipart/mixed; boundary=%@", boundary] forHTTPHeaderField:@"Content-Type"];
+    [batchRequest setHTTPBody:body];
+
+    return batchRequest;
+}
+
+- (NSArray *)itemResponsesWithData:(NSData *)data
+                          response:(NSHTTPURLResponse *)response
+                          requests:(NSArray *)requests
+                             error:(NSError **)error {
+    NSString *boundary = [self boundaryForContentType:[self valueForHeaderField:@"Content-Type" inHeaders:response.allHeaderFields]];
+    NSArray *parts = boundary ? [self partsOfData:data boundary:boundary] : nil;
+
+    if (!parts) {
+        if (error)
+            *error = NetworkBatchError(NetworkBatchEnvelopeErrorCodeMalformedResponse, response.URL, @"Batch response is not multipart/mixed");
+        return nil;
+    }
+
+    NSMutableArray *results = NetworkBatchMissingResponses(requests);
+
+    [parts enumerateObjectsUsingBlock:^(NSData *part, NSUInteger idx, BOOL *stop) {
+        NSDictionary *partHeaders;
+        NSData *partBody = [self bodyOfMessage:part headers:&partHeaders statusCode:NULL];
+
+        NSInteger index = (NSInteger)idx;
+        NSString *contentID = [self valueForHeaderField:@"Content-ID" inHeaders:partHeaders];
+        if (contentID) {
+            NSString *trimmed = [contentID stringByTrimmingCharactersInSet:[NSCharacterSet characterSetWithCharactersInString:@"<> "]];
+            index = [[[trimmed componentsSeparatedByString:@"-"] lastObject] integerValue];
+        }
+        if (!partBody || index < 0 || index >= (NSInteger)[requests count])
+            return;
+
+        // the part's body is itself an HTTP response, starting with its status line
+
+        NSDictionary *headers;
+        NSInteger statusCode;
+        NSData *body = [self bodyOfMessage:partBody headers:&headers statusCode:&statusCode];
+        if (!body)
+            return;
+
+        NSURLRequest *request = requests[index];
+
+        NetworkBatchItemResponse *itemResponse = [[NetworkBatchItemResponse alloc] init];
+        itemResponse.response = [[NSHTTPURLResponse alloc] initWithURL:request.URL statusCode:statusCode HTTPVersion:@"HTTP/1.1" headerFields:headers];
+        itemResponse.data = body;
+
+        results[index] = itemResponse;
+    }];
+
+    return results;
+}
+
+#pragma mark Parsing
+
+- (NSString *)valueForHeaderField:(NSString *)field inHeaders:(NSDictionary *)headers {
+    for (NSString *key in headers) {
+        if ([key caseInsensitiveCompare:field] == NSOrderedSame)
+            return headers[key];
+    }
+    return nil;
+}
+
+- (NSString *)boundaryForContentType:(NSString *)contentType {
+    for (NSString *parameter in [contentType componentsSeparatedByString:@";"]) {
+        NSString *trimmed = [parameter stringByTrimmingCharactersInSet:[NSCharacterSet whitespaceCharacterSet]];
+        if ([[trimmed lowercaseString] hasPrefix:@"boundary="])
+            return [[trimmed substringFromIndex:9] stringByTrimmingCharactersInSet:[NSCharacterSet characterSetWithCharactersInString:@"\""]];
+    }
+    return nil;
+}
+
+/* Split a multipart body into its parts (excluding the delimiters and the CRLF that precedes each of them).
+ */
+- (NSArray *)partsOfData:(NSData *)data boundary:(NSString *)boundary {
+    NSData *firstDelimiter = [[NSString stringWithFormat:@"--%@", boundary] dataUsingEncoding:NSUTF8StringEncoding];
+    NSData *delimiter = [[NSString stringWithFormat:@"\r\n--%@", boundary] dataUsingEncoding:NSUTF8StringEncoding];
+    NSData *lineEnd = [@"\r\n" dataUsingEncoding:NSUTF8StringEncoding];
+
+    NSRange range = [data rangeOfData:firstDelimiter options:0 range:NSMakeRange(0, [data length])];
+    if (range.location == NSNotFound)
+        return nil;
+
+    NSMutableArray *parts = [NSMutableArray array];
+
+    while (YES) {
+        NSUInteger afterDelimiter = NSMaxRange(range);
+
+        // the closing delimiter is followed by "--"
+
+        if (afterDelimiter + 2 <= [data length] && memcmp((const char *)[data bytes] + afterDelimiter, "--", 2) == 0)
+            break;
+
+        NSRange lineEndRange = [data rangeOfData:lineEnd options:0 range:NSMakeRange(afterDelimiter, [data length] - afterDelimiter)];
+        if (lineEndRange.location == NSNotFound)
+            break;
+
+        NSUInteger start = NSMaxRange(lineEndRange);
+        range = [data rangeOfData:delimiter options:0 range:NSMakeRange(start, [data length] - start)];
+        if (range.location == NSNotFound)
+            break;
+
+        [parts addObject:[data subdataWithRange:NSMakeRange(start, range.location - start)]];
+    }
+
+    return parts;
+}
+
+/* Split a MIME part or HTTP message into its headers and body.
+ *
+ * @param message    The part or message.
+ * @param headers    Set to the headers.
+ * @param statusCode If not `NULL`, the message is expected to start with an HTTP status line, and this is set to its status code.
+ *
+ * @return           The body, or `nil` if the message is malformed.
+ */
+- (NSData *)bodyOfMessage:(NSData *)message headers:(NSDictionary **)headers statusCode:(NSInteger *)statusCode {
+    NSData *separator = [@"\r\n\r\n" dataUsingEncoding:NSUTF8StringEncoding];
+    NSRange separatorRange = [message rangeOfData:separator options:0 range:NSMakeRange(0, [message length])];
+    if (separatorRange.location == NSNotFound)
+        return nil;
+
+    NSString *head = [[NSString alloc] initWithData:[message subdataWithRange:NSMakeRange(0, separatorRange.location)] encoding:NSUTF8StringEncoding];
+    if (!head)
+        return nil;
+
+    NSMutableArray *lines = [[head componentsSeparatedByString:@"\r\n"] mutableCopy];
+
+    if (statusCode) {
+        NSArray *statusLine = [[lines firstObject] componentsSeparatedByString:@" "];
+        if ([statusLine count] < 2 || ![statusLine[0] hasPrefix:@"HTTP/"])
+            return nil;
+        *statusCode = [statusLine[1] integerValue];
+        [lines removeObjectAtIndex:0];
+    }
+
+    NSMutableDictionary *fields = [NSMutableDictionary dictionary];
+    for (NSString *line in lines) {
+        NSRange colon = [line rangeOfString:@":"];
+        if (colon.location == NSNotFound)
+            continue;
+        NSString *key = [line substringToIndex:colon.location];
+        NSString *value = [[line substringFromIndex:NSMaxRange(colon)] stringByTrimmingCharactersInSet:[NSCharacterSet whitespaceCharacterSet]];
+        fields[key] = value;
+    }
+    *headers = fields;
+
+    NSUInteger start = NSMaxRange(separatorRange);
+    return [message subdataWithRange:NSMakeRange(start, [message length] - start)];
+}
+
+@end
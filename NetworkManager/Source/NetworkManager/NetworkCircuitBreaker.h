@@ -0,0 +1,128 @@
+//
+//  NetworkCircuitBreaker.h
+//
+//  Created by agent on 10/19/26.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+//  This work is licensed under a Creative Commons Attribution-ShareAlike 4.0 International License.
+//  http://creativecommons.org/licenses/by-sa/4.0/
+
+#import <Foundation/Foundation.h>
+
+extern NSString * const kNetworkCircuitBreakerErrorDomain;
+
+typedef NS_ENUM(NSInteger, NetworkCircuitBreakerErrorCode) {
+    NetworkCircuitBreakerErrorCodeOpen = 1
+};
+
+typedef NS_ENUM(NSInteger, NetworkCircuitBreakerState) {
+    NetworkCircuitBreakerStateClosed,
+    NetworkCircuitBreakerStateOpen,
+    NetworkCircuitBreakerStateHalfOpen
+};
+
+/** Per-host circuit breaker.
+
+ When assigned to the `circuitBreaker` property of a `<NetworkManager>`, the manager reports the outcome of every
+ task to the breaker and asks it, in `addOperation:`, whether a new operation for a given host may proceed.
+
+ A host's circuit is _closed_ (requests proceed normally) until either `<consecutiveFailureThreshold>` failures in a row
+ are observed, or the failure rate over the last `<failureRateWindow>` requests reaches `<failureRateThreshold>`. The circuit
+ then _opens_: new operations for that host are failed immediately with a `kNetworkCircuitBreakerErrorDomain` error,
+ without taking a slot in the manager's `networkQueue`. After `<cooldown>` seconds, the circuit becomes _half-open_
+ and lets up to `<halfOpenProbeLimit>` probe requests through. If they all succeed, the circuit closes; if any fails, it opens again.
+
+ A task counts as a failure if it fails with a `NSURLErrorDomain` error (other than cancelation) or if the server responds
+ with a 5xx status code.
+ */
+
+@interface NetworkCircuitBreaker : NSObject
+
+/// ----------------
+/// @name Properties
+/// ----------------
+
+/// The number of consecutive failures that trips the circuit. Default is 5.
+
+@property (nonatomic) NSUInteger consecutiveFailureThreshold;
+
+/// The failure rate (from 0.0 to 1.0) that trips the circuit. Default is 0.5.
+
+@property (nonatomic) double failureRateThreshold;
+
+/// The number of most recent requests over which the failure rate is calculated. The rate is not evaluated until this many requests have completed. Default is 20.
+
+@property (nonatomic) NSUInteger failureRateWindow;
+
+/// The number of seconds a circuit stays open before it lets probe requests through. Default is 30 seconds.
+
+@property (nonatomic) NSTimeInterval cooldown;
+
+/// The number of probe requests permitted (and the number of successes required to close the circuit) while half-open. Default is 1.
+
+@property (nonatomic) NSUInteger halfOpenProbeLimit;
+
+/// ------------------
+/// @name Admission
+/// ------------------
+
+/** Determine whether a task may proceed, based upon the circuit for the host of its request.
+ *
+ * If the circuit is half-open and this returns `YES`, the task is admitted as one of the probes. Only the
+ * completions of probes (as reported to `<recordCompletionOfTask:error:>`) free a probe slot or decide
+ * whether the circuit closes or opens again.
+ *
+ * @param task  The task about to be started.
+ * @param error If the request may not proceed, this will be set to the error with which the request should fail.
+ *
+ * @return `YES` if the request may proceed. `NO` if the circuit for this host is open.
+ */
+
+- (BOOL)shouldAllowTask:(NSURLSessionTask *)task error:(NSError **)error;
+
+/** Record the outcome of a task.
+ *
+ * @param task  The task that completed.
+ * @param error The error, if any, with which the task completed.
+ */
+
+- (void)recordCompletionOfTask:(NSURLSessionTask *)task error:(NSError *)error;
+
+/** Free the probe slot of a task that was admitted while half-open, but whose completion will never be recorded.
+ *
+ * For example, an operation that is canceled before it starts never resumes its task, so the session never reports it.
+ * This doesn't count as an outcome. It does nothing if the task isn't a probe (or its completion has already been recorded).
+ *
+ * `<NetworkManager>` calls this, through `NetworkTaskOperation`, when an admitted operation finishes.
+ *
+ * @param task  The task that was admitted.
+ */
+
+- (void)releaseProbeSlotOfTask:(NSURLSessionTask *)task;
+
+/// ------------------
+/// @name Monitoring
+/// ------------------
+
+/** The current state of a host's circuit.
+ *
+ * @param host The host name.
+ *
+ * @return The `NetworkCircuitBreakerState`. Hosts that have never been seen are `NetworkCircuitBreakerStateClosed`.
+ */
+
+- (NetworkCircuitBreakerState)stateForHost:(NSString *)host;
+
+/** Snapshot of the state of every host seen so far.
+ *
+ * @return `NSDictionary` keyed by host name, whose values are `NSNumber` representations of `NetworkCircuitBreakerState`.
+ */
+
+- (NSDictionary *)hostStates;
+
+/** Close every circuit and forget all recorded outcomes.
+ */
+
+- (void)reset;
+
+@end
@@ -0,0 +1,247 @@
+//
+//  NetworkCircuitBreaker.m
+//
+//  Created by agent on 10/19/26.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+//  This work is licensed under a Creative Commons Attribution-ShareAlike 4.0 International License.
+//  http://creativecommons.org/licenses/by-sa/4.0/
+
+#import "NetworkCircuitBreaker.h"
+
+NSString * const kNetworkCircuitBreakerErrorDomain = @"NetworkCircuitBreaker";
+
+/** Bookkeeping for a single host's circuit.
+ */
+@interface NetworkCircuitBreakerHost : NSObject
+@property (nonatomic) NetworkCircuitBreakerState state;
+@property (nonatomic) NSUInteger consecutiveFailures;
+@property (nonatomic, strong) NSMutableArray *outcomes;
+@property (nonatomic) CFAbsoluteTime openedTime;
+@property (nonatomic, strong) NSMutableSet *probeTasks;
+@property (nonatomic) NSUInteger probeSuccesses;
+@end
+
+@implementation NetworkCircuitBreakerHost
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        _state = NetworkCircuitBreakerStateClosed;
+        _outcomes = [NSMutableArray array];
+        _probeTasks = [NSMutableSet set];
+    }
+    return self;
+}
+
+@end
+
+
+@interface NetworkCircuitBreaker ()
+
+@property (nonatomic, strong) NSMutableDictionary *hosts;
+
+@end
+
+@implementation NetworkCircuitBreaker
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        _hosts = [[NSMutableDictionary alloc] init];
+        _consecutiveFailureThreshold = 5;
+        _failureRateThreshold = 0.5;
+        _failureRateWindow = 20;
+        _cooldown = 30.0;
+        _halfOpenProbeLimit = 1;
+    }
+    return self;
+}
+
+#pragma mark - Admission
+
+- (BOOL)shouldAllowTask:(NSURLSessionTask *)task error:(NSError **)error {
+    NSString *host = task.originalRequest.URL.host;
+    if (!host)
+        return YES;
+
+    @synchronized(self) {
+        NetworkCircuitBreakerHost *record = self.hosts[host];
+
+        [self transitionToHalfOpenIfCooledDown:record];
+
+        switch (record.state) {
+            case NetworkCircuitBreakerStateClosed:
+                return YES;
+
+            case NetworkCircuitBreakerStateHalfOpen:
+                if ([record.probeTasks count] < self.halfOpenProbeLimit) {
+                    [record.probeTasks addObject:task];
+                    return YES;
+                }
+                break;
+
+            case NetworkCircuitBreakerStateOpen:
+                break;
+        }
+    }
+
+    if (error) {
+        NSString *description = [NSString stringWithFormat:@"Requests to %@ are temporarily suspended after repeated failures.", host];
+        *error = [NSError errorWithDomain:kNetworkCircuitBreakerErrorDomain
+                                     code:NetworkCircuitBreakerErrorCodeOpen
+                                 userInfo:@{NSLocalizedDescriptionKey: description, @"host": host}];
+    }
+
+    return NO;
+}
+
+- (void)recordCompletionOfTask:(NSURLSessionTask *)task error:(NSError *)error {
+    NSString *host = task.originalRequest.URL.host;
+    if (!host)
+        return;
+
+    BOOL failed = NO;
+    BOOL inconclusive = NO;
+
+    if ([task.response isKindOfClass:[NSHTTPURLResponse class]] && [(NSHTTPURLResponse *)task.response statusCode] >= 500) {
+        failed = YES;
+    } else if ([error.domain isEqualToString:NSURLErrorDomain] && error.code != NSURLErrorCancelled) {
+        failed = YES;
+    } else if (error && !task.response) {
+        // canceled (or failed for reasons of our own) before the server was heard from, which says nothing about the host's health
+
+        inconclusive = YES;
+    }
+
+    @synchronized(self) {
+        NetworkCircuitBreakerHost *record = self.hosts[host];
+        if (!record) {
+            if (inconclusive)
+                return;
+
+            record = [[NetworkCircuitBreakerHost alloc] init];
+            self.hosts[host] = record;
+        }
+
+        switch (record.state) {
+            case NetworkCircuitBreakerStateOpen:
+                // stragglers that were in flight when the circuit opened
+
+                break;
+
+            case NetworkCircuitBreakerStateHalfOpen:
+                // only the probes speak for the host's recovery; anything else (requests that were already running
+                // when the circuit opened, or requests that were rejected) neither frees a probe slot nor counts
+
+                if (![record.probeTasks containsObject:task])
+                    break;
+
+                [record.probeTasks removeObject:task];
+
+                if (inconclusive) {
+                    break;
+                } else if (failed) {
+                    [self open:record];
+                } else if (++record.probeSuccesses >= self.halfOpenProbeLimit) {
+                    [self close:record];
+                }
+                break;
+
+            case NetworkCircuitBreakerStateClosed:
+                if (inconclusive)
+                    break;
+
+                record.consecutiveFailures = failed ? record.consecutiveFailures + 1 : 0;
+
+                [record.outcomes addObject:@(failed)];
+                while ([record.outcomes count] > self.failureRateWindow)
+                    [record.outcomes removeObjectAtIndex:0];
+
+                if (record.consecutiveFailures >= self.consecutiveFailureThreshold || [self failureRateExceeded:record])
+                    [self open:record];
+                break;
+        }
+    }
+}
+
+- (void)releaseProbeSlotOfTask:(NSURLSessionTask *)task {
+    NSString *host = task.originalRequest.URL.host;
+    if (!host)
+        return;
+
+    @synchronized(self) {
+        NetworkCircuitBreakerHost *record = self.hosts[host];
+        [record.probeTasks removeObject:task];
+    }
+}
+
+#pragma mark - Monitoring
+
+- (NetworkCircuitBreakerState)stateForHost:(NSString *)host {
+    if (!host)
+        return NetworkCircuitBreakerStateClosed;
+
+    @synchronized(self) {
+        NetworkCircuitBreakerHost *record = self.hosts[host];
+        [self transitionToHalfOpenIfCooledDown:record];
+        return record ? record.state : NetworkCircuitBreakerStateClosed;
+    }
+}
+
+- (NSDictionary *)hostStates {
+    NSMutableDictionary *states = [NSMutableDictionary dictionary];
+
+    @synchronized(self) {
+        [self.hosts enumerateKeysAndObjectsUsingBlock:^(NSString *host, NetworkCircuitBreakerHost *record, BOOL *stop) {
+            [self transitionToHalfOpenIfCooledDown:record];
+            states[host] = @(record.state);
+        }];
+    }
+
+    return states;
+}
+
+- (void)reset {
+    @synchronized(self) {
+        [self.hosts removeAllObjects];
+    }
+}
+
+#pragma mark - State transitions
+
+- (BOOL)failureRateExceeded:(NetworkCircuitBreakerHost *)record {
+    if (self.failureRateWindow == 0 || [record.outcomes count] < self.failureRateWindow)
+        return NO;
+
+    NSUInteger failures = 0;
+    for (NSNumber *outcome in record.outcomes) {
+        if ([outcome boolValue])
+            failures++;
+    }
+
+    return (double)failures / [record.outcomes count] >= self.failureRateThreshold;
+}
+
+- (void)transitionToHalfOpenIfCooledDown:(NetworkCircuitBreakerHost *)record {
+    if (record.state == NetworkCircuitBreakerStateOpen && CFAbsoluteTimeGetCurrent() - record.openedTime >= self.cooldown) {
+        record.state = NetworkCircuitBreakerStateHalfOpen;
+        [record.probeTasks removeAllObjects];
+        record.probeSuccesses = 0;
+    }
+}
+
+- (void)open:(NetworkCircuitBreakerHost *)record {
+    record.state = NetworkCircuitBreakerStateOpen;
+    [record.probeTasks removeAllObjects];
+    record.openedTime = CFAbsoluteTimeGetCurrent();
+}
+
+- (void)close:(NetworkCircuitBreakerHost *)record {
+    record.state = NetworkCircuitBreakerStateClosed;
+    [record.probeTasks removeAllObjects];
+    record.consecutiveFailures = 0;
+    [record.outcomes removeAllObjects];
+}
+
+@end
@@ -32,6 +32,9 @@ typedef void(^WillCacheResponseHandler)(NetworkDataTaskOperation *operation,
 typedef void(^DidBecomeDownloadTaskHandler)(NetworkDataTaskOperation *operation,
                                             NSURLSessionDownloadTask *downloadTask);
 
+typedef NSURLSessionDataTask *(^HedgeTaskProvider)(NetworkDataTaskOperation *operation,
+                                                   NSURLRequest *request);
+
 /** Operation that wraps delegate-based NSURLSessionDataDask.
  *
  * This is a `<NetworkTaskOperation>` subclass instantiated by `<NetworkManager>` method
@@ -119,4 +122,66 @@ typedef void(^DidBecomeDownloadTaskHandler)(NetworkDataTaskOperation *operation,
 
 @property (nonatomic, copy) DidBecomeDownloadTaskHandler didBecomeDownloadTaskHandler;
 
+/// --------------------
+/// @name Hedged requests
+/// --------------------
+
+/** If greater than zero, the number of seconds to wait for a response before a second, identical
+ task is started. Whichever task receives a response first wins; the other one is cancelled.
+ The default is zero, meaning that the request is never hedged.
+ 
+ This is generally set by `<NetworkManager>` method `dataOperationWithRequest:hedgeDelay:progressHandler:completionHandler:`,
+ which only enables hedging for idempotent requests.
+ */
+
+@property (nonatomic) NSTimeInterval hedgeDelay;
+
+/** Called when `hedgeDelay` elapses without a response, to create (but not resume) the duplicate task.
+ Return `nil` if the request should not be hedged (e.g. the hedge budget has been exhausted).
+
+ Uses the following typedef:
+
+    typedef NSURLSessionDataTask *(^HedgeTaskProvider)(NetworkDataTaskOperation *operation,
+                                                       NSURLRequest *request);
+ */
+
+@property (nonatomic, copy) HedgeTaskProvider            hedgeTaskProvider;
+
+/** The duplicate task started after `hedgeDelay`, if any. 
+ 
+ Once one of the tasks has received a response, `task` is always the winning task and
+ `hedgeTask` is the one that lost (and was cancelled).
+ */
+
+@property (nonatomic, weak, readonly) NSURLSessionDataTask *hedgeTask;
+
+/** The number of seconds between the start of the operation and the receipt of the first response.
+ This is zero until a response has been received.
+ */
+
+@property (nonatomic, readonly) NSTimeInterval responseLatency;
+
+/** Called by `<NetworkManager>` when one of this operation's tasks completes.
+ *
+ * @param task The task that completed.
+ *
+ * @return `YES` if this completion finishes the operation. `NO` if the task was a hedge that lost
+ *         (or failed while the other task is still running), in which case the completion should be ignored.
+ */
+
+- (BOOL)completionOfTaskFinishesOperation:(NSURLSessionTask *)task;
+
+/// ------------------
+/// @name Spilling
+/// ------------------
+
+/** Move the response received thus far to a temporary file, to which the rest of the response will be written.
+ *
+ * This is called by the `memoryMonitor` when it starts shedding load (so that even a response whose task it is about
+ * to suspend gives up its buffer), and by the operation itself when its buffer grows past the monitor's `spillThreshold`.
+ * It may be called from any thread, and does nothing if the response has already been spilled or delivered.
+ */
+
+- (void)spillResponseData;
+
 @end
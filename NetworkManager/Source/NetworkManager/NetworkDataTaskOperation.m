@@ -17,6 +17,15 @@
 @property (nonatomic, strong) NSMutableData *responseData;
 @property (nonatomic, strong) NSError *error;
 
+@property (nonatomic, copy)   NSURLRequest *request;
+@property (nonatomic, weak, readwrite) NSURLSessionDataTask *hedgeTask;
+@property (nonatomic, readwrite) NSTimeInterval responseLatency;
+@property (nonatomic) CFAbsoluteTime startTime;
+@property (nonatomic, strong) NSNumber *winningTaskIdentifier;
+@property (nonatomic, strong) NSMutableSet *pendingTaskIdentifiers;
+@property (nonatomic, strong) NSURL *spillURL;
+@property (nonatomic, strong) NSFileHandle *spillFileHandle;
+
 @end
 
 @implementation NetworkDataTaskOperation
@@ -26,30 +35,204 @@
     self = [super init];
     if (self) {
         self.task = [session dataTaskWithRequest:request];
+        self.request = request;
     }
     return self;
 }
 
+- (NSMutableSet *)pendingTaskIdentifiers {
+    if (!_pendingTaskIdentifiers) {
+        _pendingTaskIdentifiers = [NSMutableSet set];
+    }
+    return _pendingTaskIdentifiers;
+}
+
+- (void)start {
+    @synchronized(self) {
+        self.startTime = CFAbsoluteTimeGetCurrent();
+        if (self.task) {
+            [self.pendingTaskIdentifiers addObject:@(self.task.taskIdentifier)];
+        }
+    }
+
+    [super start];
+
+    if ([self isExecuting] && self.hedgeDelay > 0 && self.hedgeTaskProvider) {
+        __weak NetworkDataTaskOperation *weakSelf = self;
+        dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(self.hedgeDelay * NSEC_PER_SEC)), dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+            [weakSelf startHedgeTask];
+        });
+    }
+}
+
+- (void)cancel {
+    [self.hedgeTask cancel];
+    [super cancel];
+}
+
+#pragma mark - Hedging
+
+/* Start the duplicate task, unless we've already received a response, finished, or been canceled.
+ */
+- (void)startHedgeTask {
+    NSURLSessionDataTask *hedgeTask;
+
+    @synchronized(self) {
+        if ([self isFinished] || [self isCancelled] || self.winningTaskIdentifier || self.hedgeTask || !self.request)
+            return;
+
+        hedgeTask = self.hedgeTaskProvider(self, self.request);
+        if (!hedgeTask)
+            return;
+
+        self.hedgeTask = hedgeTask;
+        [self.pendingTaskIdentifiers addObject:@(hedgeTask.taskIdentifier)];
+    }
+
+    [hedgeTask resume];
+}
+
+/* Called when a response arrives. The first task to receive a response wins and the other is canceled.
+ *
+ * @return YES if `dataTask` is the winning task; NO if it lost the race and should be canceled.
+ */
+- (BOOL)claimResponseForDataTask:(NSURLSessionDataTask *)dataTask {
+    NSURLSessionTask *losingTask;
+
+    @synchronized(self) {
+        if (self.winningTaskIdentifier)
+            return [self.winningTaskIdentifier isEqualToNumber:@(dataTask.taskIdentifier)];
+
+        self.winningTaskIdentifier = @(dataTask.taskIdentifier);
+        self.responseLatency = CFAbsoluteTimeGetCurrent() - self.startTime;
+
+        if (dataTask != self.task) {
+            losingTask = self.task;
+            self.task = dataTask;
+            self.hedgeTask = (NSURLSessionDataTask *)losingTask;
+        } else {
+            losingTask = self.hedgeTask;
+        }
+    }
+
+    [losingTask cancel];
+
+    return YES;
+}
+
+- (BOOL)isLosingTask:(NSURLSessionTask *)task {
+    @synchronized(self) {
+        return self.winningTaskIdentifier && ![self.winningTaskIdentifier isEqualToNumber:@(task.taskIdentifier)];
+    }
+}
+
+- (BOOL)completionOfTaskFinishesOperation:(NSURLSessionTask *)task {
+    @synchronized(self) {
+        [self.pendingTaskIdentifiers removeObject:@(task.taskIdentifier)];
+
+        if (self.winningTaskIdentifier)
+            return [self.winningTaskIdentifier isEqualToNumber:@(task.taskIdentifier)];
+
+        return [self.pendingTaskIdentifiers count] == 0;
+    }
+}
+
 #pragma mark - NSURLSessionTaskDelegate
 
 - (void)URLSession:(NSURLSession *)session task:(NSURLSessionTask *)task didCompleteWithError:(NSError *)error {
+    NSData *responseData;
+
+    // the memory monitor may ask us to spill from another thread, so take the response (and stop any spilling) atomically
+
+    @synchronized(self) {
+        responseData = self.spillURL ? [self spilledResponseData] : self.responseData;
+        self.responseData = nil;
+    }
+
     if (self.didCompleteWithDataErrorHandler) {
-        dispatch_sync(self.completionQueue ?: dispatch_get_main_queue(), ^{
-            self.didCompleteWithDataErrorHandler(self, self.responseData, error);
+        [self performHandlerNamed:"didComplete" bytes:(int64_t)[responseData length] block:^{
+            self.didCompleteWithDataErrorHandler(self, responseData, error);
             self.didCompleteWithDataErrorHandler = nil;
-        });
+        }];
     }
 
     [self completeOperation];
 }
 
+#pragma mark - Spilling
+
+/* If the file can't be created, we just keep the response in memory.
+ *
+ * The monitor is told after the lock is released, since telling it may lead it to ask other operations to spill.
+ */
+- (void)spillResponseData {
+    int64_t spilledBytes;
+
+    @synchronized(self) {
+        if (self.spillFileHandle || [self.responseData length] == 0)
+            return;
+
+        NSURL *url = [NSURL fileURLWithPath:[NSTemporaryDirectory() stringByAppendingPathComponent:[[NSUUID UUID] UUIDString]]];
+
+        if (![self.responseData writeToURL:url options:0 error:nil])
+            return;
+
+        NSFileHandle *fileHandle = [NSFileHandle fileHandleForWritingToURL:url error:nil];
+        if (!fileHandle) {
+            [[NSFileManager defaultManager] removeItemAtURL:url error:nil];
+            return;
+        }
+        [fileHandle seekToEndOfFile];
+
+        self.spillURL = url;
+        self.spillFileHandle = fileHandle;
+
+        spilledBytes = (int64_t)[self.responseData length];
+        self.responseData = nil;
+    }
+
+    [self.memoryMonitor operation:self didSpillBytes:spilledBytes];
+}
+
+- (void)appendSpilledData:(NSData *)data {
+    @try {
+        [self.spillFileHandle writeData:data];
+    }
+    @catch (NSException *exception) {
+        [self cancelWithError:[NSError errorWithDomain:NSCocoaErrorDomain code:NSFileWriteOutOfSpaceError userInfo:@{NSURLErrorKey: self.spillURL}]];
+    }
+}
+
+/* The spilled response, memory-mapped (so it doesn't count against our footprint), and the temporary file removed.
+ */
+- (NSData *)spilledResponseData {
+    [self.spillFileHandle closeFile];
+    self.spillFileHandle = nil;
+
+    NSData *data = [NSData dataWithContentsOfURL:self.spillURL options:NSDataReadingMappedIfSafe error:nil];
+
+    // once mapped, the data remains valid after the file is removed
+
+    [[NSFileManager defaultManager] removeItemAtURL:self.spillURL error:nil];
+    self.spillURL = nil;
+
+    return data;
+}
+
 #pragma mark - NSURLSessionDataDelegate
 
 - (void)URLSession:(NSURLSession *)session dataTask:(NSURLSessionDataTask *)dataTask didReceiveResponse:(NSURLResponse *)response completionHandler:(void (^)(NSURLSessionResponseDisposition disposition))completionHandler {
+    if (![self claimResponseForDataTask:dataTask]) {
+        completionHandler(NSURLSessionResponseCancel);
+        return;
+    }
+
+    [self.tracer recordInstantNamed:"response" category:"network" task:dataTask bytes:response.expectedContentLength];
+
     if (self.didReceiveResponseHandler) {
-        dispatch_sync(self.completionQueue ?: dispatch_get_main_queue(), ^{
+        [self performHandlerNamed:"didReceiveResponse" bytes:-1 block:^{
             self.didReceiveResponseHandler(self, response, completionHandler);
-        });
+        }];
     } else {
         if ([response isKindOfClass:[NSHTTPURLResponse class]]) {
             NSInteger statusCode = [(NSHTTPURLResponse *)response statusCode];
@@ -72,32 +255,61 @@
 }
 
 - (void)URLSession:(NSURLSession *)session dataTask:(NSURLSessionDataTask *)dataTask didReceiveData:(NSData *)data {
+    if ([self isLosingTask:dataTask])
+        return;
+
     self.bytesReceived += [data length];
 
     if (self.didReceiveDataHandler) {
-        dispatch_sync(self.completionQueue ?: dispatch_get_main_queue(), ^{
+        [self performHandlerNamed:"didReceiveData" bytes:(int64_t)[data length] block:^{
             self.didReceiveDataHandler(self, data, self.totalBytesExpected, self.bytesReceived);
-        });
+        }];
     } else {
-        if (!self.responseData) {
-            self.responseData = [NSMutableData dataWithData:data];
-        } else {
-            [self.responseData appendData:data];
+        // with no handler, the data is accumulated (or spilled) right here on the delegate queue, so time that instead
+
+        NetworkTracer *tracer = self.tracer;
+        uint64_t start = tracer ? NetworkTracerNow() : 0;
+
+        BOOL spilled;
+        NSUInteger length = 0;
+
+        @synchronized(self) {
+            spilled = self.spillFileHandle != nil;
+
+            if (spilled) {
+                [self appendSpilledData:data];
+            } else {
+                if (!self.responseData) {
+                    self.responseData = [NSMutableData dataWithData:data];
+                } else {
+                    [self.responseData appendData:data];
+                }
+                length = [self.responseData length];
+            }
         }
+
+        if (!spilled && self.memoryMonitor) {
+            [self.memoryMonitor operation:self didAddBytes:(int64_t)[data length] category:NetworkMemoryCategoryResponseBuffer];
+
+            if ([self.memoryMonitor shouldSpillResponseOfLength:length])
+                [self spillResponseData];
+        }
+
+        [tracer recordSpanNamed:"accumulateData" category:"data" start:start end:NetworkTracerNow() task:dataTask bytes:(int64_t)[data length]];
     }
 
     if (self.progressHandler) {
-        dispatch_sync(self.completionQueue ?: dispatch_get_main_queue(), ^{
+        [self performHandlerNamed:"progress" bytes:self.bytesReceived block:^{
             self.progressHandler(self, self.totalBytesExpected, self.bytesReceived);
-        });
+        }];
     }
 }
 
 - (void)URLSession:(NSURLSession *)session dataTask:(NSURLSessionDataTask *)dataTask willCacheResponse:(NSCachedURLResponse *)proposedResponse completionHandler:(void (^)(NSCachedURLResponse *cachedResponse))completionHandler {
     if (self.willCacheResponseHandler) {
-        dispatch_sync(self.completionQueue ?: dispatch_get_main_queue(), ^{
+        [self performHandlerNamed:"willCacheResponse" bytes:-1 block:^{
             self.willCacheResponseHandler(self, proposedResponse, completionHandler);
-        });
+        }];
     } else {
         completionHandler(proposedResponse);
     }
@@ -105,9 +317,9 @@
 
 - (void)URLSession:(NSURLSession *)session dataTask:(NSURLSessionDataTask *)dataTask didBecomeDownloadTask:(NSURLSessionDownloadTask *)downloadTask {
     if (self.didBecomeDownloadTaskHandler) {
-        dispatch_sync(self.completionQueue ?: dispatch_get_main_queue(), ^{
+        [self performHandlerNamed:"didBecomeDownloadTask" bytes:-1 block:^{
             self.didBecomeDownloadTaskHandler(self, downloadTask);
-        });
+        }];
     }
 }
 
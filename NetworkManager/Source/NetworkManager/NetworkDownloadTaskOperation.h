@@ -68,6 +68,22 @@ typedef void(^DidWriteDataHandler)(NetworkDownloadTaskOperation *operation,
  */
 @property (nonatomic, copy) DidWriteDataHandler         didWriteDataHandler;
 
+/** The file URL to which the download should be moved when it finishes. Default is `nil`.
+ 
+ If set, the downloaded file is moved here (replacing any existing file) before `didFinishDownloadingHandler`
+ is called, and that is the `location` the handler receives. For background sessions, this is persisted
+ with the task, so a download that finishes after a relaunch ends up in the right place even before
+ its handlers have been reattached.
+ */
+@property (nonatomic, strong) NSURL *destinationURL;
+
+/** The error moving the downloaded file to `destinationURL`, if that failed.
+
+ This is passed to `didFinishDownloadingHandler`, if there is one, and in any case is reported as the error of the
+ task's completion (e.g. to the manager's `didCompleteWithError`), since the download didn't end up where it should.
+ */
+@property (nonatomic, strong, readonly) NSError *moveError;
+
 
 /// -----------------------
 /// @name Cancel and resume
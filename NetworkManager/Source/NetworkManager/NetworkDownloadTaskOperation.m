@@ -9,6 +9,12 @@
 
 #import "NetworkDownloadTaskOperation.h"
 
+@interface NetworkDownloadTaskOperation ()
+
+@property (nonatomic, strong, readwrite) NSError *moveError;
+
+@end
+
 @implementation NetworkDownloadTaskOperation
 
 #pragma mark - NSURLSessionDownloadDelegate
@@ -53,12 +59,12 @@
                 error = [NSError errorWithDomain:NSStringFromClass([self class]) code:statusCode userInfo:@{@"statusCode": @(statusCode), @"response": task.response}];
         }
 
-        dispatch_sync(self.completionQueue ?: dispatch_get_main_queue(), ^{
+        [self performHandlerNamed:"didFinishDownloading" bytes:-1 block:^{
             self.didFinishDownloadingHandler(self, nil, error);
             self.didFinishDownloadingHandler = nil;
             self.didResumeHandler = nil;
             self.didWriteDataHandler = nil;
-        });
+        }];
     } else {
         self.didResumeHandler = nil;
         self.didWriteDataHandler = nil;
@@ -70,13 +76,22 @@
 #pragma mark - NSURLSessionDownloadTaskDelegate
 
 - (void)URLSession:(NSURLSession *)session downloadTask:(NSURLSessionDownloadTask *)downloadTask didFinishDownloadingToURL:(NSURL *)location {
+    NSError *error;
+
+    if (self.destinationURL) {
+        NSFileManager *fileManager = [NSFileManager defaultManager];
+        [fileManager removeItemAtURL:self.destinationURL error:nil];
+        location = [fileManager moveItemAtURL:location toURL:self.destinationURL error:&error] ? self.destinationURL : nil;
+        self.moveError = error;
+    }
+
     if (self.didFinishDownloadingHandler) {
-        dispatch_sync(self.completionQueue ?: dispatch_get_main_queue(), ^{
-            self.didFinishDownloadingHandler(self, location, nil);
+        [self performHandlerNamed:"didFinishDownloading" bytes:downloadTask.countOfBytesReceived block:^{
+            self.didFinishDownloadingHandler(self, location, error);
             self.didFinishDownloadingHandler = nil;
             self.didResumeHandler = nil;
             self.didWriteDataHandler = nil;
-        });
+        }];
     } else {
         self.didResumeHandler = nil;
         self.didWriteDataHandler = nil;
@@ -85,17 +100,17 @@
 
 - (void)URLSession:(NSURLSession *)session downloadTask:(NSURLSessionDownloadTask *)downloadTask didResumeAtOffset:(int64_t)fileOffset expectedTotalBytes:(int64_t)expectedTotalBytes {
     if (self.didResumeHandler) {
-        dispatch_sync(self.completionQueue ?: dispatch_get_main_queue(), ^{
+        [self performHandlerNamed:"didResume" bytes:fileOffset block:^{
             self.didResumeHandler(self, fileOffset, expectedTotalBytes);
-        });
+        }];
     }
 }
 
 - (void)URLSession:(NSURLSession *)session downloadTask:(NSURLSessionDownloadTask *)downloadTask didWriteData:(int64_t)bytesWritten totalBytesWritten:(int64_t)totalBytesWritten totalBytesExpectedToWrite:(int64_t)totalBytesExpectedToWrite {
     if (self.didWriteDataHandler) {
-        dispatch_sync(self.completionQueue ?: dispatch_get_main_queue(), ^{
+        [self performHandlerNamed:"didWriteData" bytes:totalBytesWritten block:^{
             self.didWriteDataHandler(self, bytesWritten, totalBytesWritten, totalBytesExpectedToWrite);
-        });
+        }];
     }
 }
 
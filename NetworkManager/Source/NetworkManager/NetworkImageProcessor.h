@@ -0,0 +1,198 @@
+//
+//  NetworkImageProcessor.h
+//
+//  Created by agent on 10/19/26.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+//  This work is licensed under a Creative Commons Attribution-ShareAlike 4.0 International License.
+//  http://creativecommons.org/licenses/by-sa/4.0/
+
+#import <UIKit/UIKit.h>
+
+typedef void(^NetworkImageProcessorCompletionHandler)(UIImage *image, NSError *error);
+
+typedef void(^NetworkImageProcessorPartialImageHandler)(UIImage *partialImage);
+
+@class NetworkIncrementalImageDecoder;
+
+/** Decodes and downsamples downloaded images off the main thread.
+
+ Rather than decoding a full resolution image on the main thread only to display it as a thumbnail,
+ this uses ImageIO to create a decoded image no larger than the requested pixel size on a bounded
+ background queue. Images from download tasks are decoded straight from the downloaded file, so the
+ full encoded image is never loaded into memory. Any format that ImageIO supports (e.g. PNG and JPEG)
+ can be processed.
+
+ Decoded images are kept in a memory-bounded cache, so table views can retrieve ready-to-display
+ images with `<cachedImageForURL:maximumPixelSize:>` before requesting them again.
+
+ Images can also be decoded progressively, as their data arrives, with a `<NetworkIncrementalImageDecoder>`
+ from `<incrementalDecoderWithMaximumPixelSize:>`.
+
+ This is generally used through the `NetworkManager (Image)` category methods.
+ */
+
+@interface NetworkImageProcessor : NSObject
+
+/// ----------------
+/// @name Properties
+/// ----------------
+
+/// The queue on which images are decoded. By default, it will decode no more than two images concurrently.
+
+@property (nonatomic, strong, readonly) NSOperationQueue *decodeQueue;
+
+/// The maximum number of bytes of decoded images kept in the cache. Default is 32 MB.
+
+@property (nonatomic) NSUInteger cacheCostLimit;
+
+/// The scale of the resulting `UIImage` objects. Default is the main screen's scale (or the scale passed to `<initWithImageScale:>`).
+
+@property (nonatomic) CGFloat imageScale;
+
+/// --------------------
+/// @name Initialization
+/// --------------------
+
+/** Create image processor whose images have the main screen's scale.
+ *
+ * `UIScreen` may only be used on the main thread, so the scale is read there, once, when the class is first used
+ * (and never by making another thread wait on the main thread). So the first processor created with this method,
+ * or the `<sharedProcessor>`, must be created on the main thread; otherwise, use `<initWithImageScale:>`.
+ *
+ * @return Returns `NetworkImageProcessor`.
+ */
+
+- (instancetype)init;
+
+/** Create image processor.
+ *
+ * @param imageScale The scale of the resulting `UIImage` objects.
+ *
+ * @return           Returns `NetworkImageProcessor`.
+ */
+
+- (instancetype)initWithImageScale:(CGFloat)imageScale;
+
+/// ----------------------
+/// @name Shared processor
+/// ----------------------
+
+/** Shared image processor.
+ *
+ * @return The shared `NetworkImageProcessor`.
+ */
+
++ (instancetype)sharedProcessor;
+
+/// ------------------
+/// @name Processing
+/// ------------------
+
+/** Decode and downsample image data.
+ *
+ * @param data             The encoded image data.
+ * @param url              The URL from which the image was retrieved, used as the cache key.
+ * @param maximumPixelSize The maximum width or height, in pixels, of the resulting image.
+ * @param queue            The queue on which the `completionHandler` should be called. If `nil`, it will use `dispatch_get_main_queue()`.
+ * @param completionHandler The block called with the decoded image (or the error if it could not be decoded).
+ */
+
+- (void)processImageData:(NSData *)data
+                  forURL:(NSURL *)url
+        maximumPixelSize:(CGFloat)maximumPixelSize
+                   queue:(dispatch_queue_t)queue
+       completionHandler:(NetworkImageProcessorCompletionHandler)completionHandler;
+
+/** Decode and downsample image file.
+ *
+ * @param fileURL          The file URL of the encoded image. The file must remain in place until the `completionHandler` is called.
+ * @param url              The URL from which the image was retrieved, used as the cache key.
+ * @param maximumPixelSize The maximum width or height, in pixels, of the resulting image.
+ * @param queue            The queue on which the `completionHandler` should be called. If `nil`, it will use `dispatch_get_main_queue()`.
+ * @param completionHandler The block called with the decoded image (or the error if it could not be decoded).
+ */
+
+- (void)processImageFileURL:(NSURL *)fileURL
+                     forURL:(NSURL *)url
+           maximumPixelSize:(CGFloat)maximumPixelSize
+                      queue:(dispatch_queue_t)queue
+          completionHandler:(NetworkImageProcessorCompletionHandler)completionHandler;
+
+/** Create decoder to decode an image progressively, as its data arrives.
+ *
+ * @param maximumPixelSize The maximum width or height, in pixels, of the resulting images.
+ *
+ * @return                 A `NetworkIncrementalImageDecoder` that decodes on this processor's `decodeQueue`.
+ */
+
+- (NetworkIncrementalImageDecoder *)incrementalDecoderWithMaximumPixelSize:(CGFloat)maximumPixelSize;
+
+/// ------------
+/// @name Cache
+/// ------------
+
+/** Retrieve previously decoded image from the cache.
+ *
+ * @param url              The URL from which the image was retrieved.
+ * @param maximumPixelSize The maximum pixel size with which it was processed.
+ *
+ * @return The `UIImage`, or `nil` if it is not in the cache.
+ */
+
+- (UIImage *)cachedImageForURL:(NSURL *)url maximumPixelSize:(CGFloat)maximumPixelSize;
+
+/** Empty the cache.
+ */
+
+- (void)removeAllCachedImages;
+
+@end
+
+/** Decodes an image progressively, as its data arrives.
+
+ As each chunk of data arrives, pass it to `<appendData:queue:partialImageHandler:>`. The decoder keeps the data
+ received thus far, updates an incremental ImageIO image source, and creates a downsampled image of whatever has been
+ decoded so far (e.g. the first scans of a progressive JPEG, or the top rows of a baseline one).
+
+ To keep the cost of decoding (and of the copy of the data each decode needs) proportional to the size of the image,
+ a decode only starts once the data has grown by a quarter since the last one, and no more than one decode is
+ pending at a time, so intermediate updates are skipped if data arrives faster than it can be decoded.
+
+ When the data is complete, call `<finish>`, and pass the data it returns to the processor's
+ `processImageData:forURL:maximumPixelSize:queue:completionHandler:` for the final (cached) image. Partial images
+ are not cached.
+ */
+
+@interface NetworkIncrementalImageDecoder : NSObject
+
+/// The maximum width or height, in pixels, of the resulting images.
+
+@property (nonatomic, readonly) CGFloat maximumPixelSize;
+
+/// The number of partial decodes performed so far.
+
+@property (nonatomic, readonly) NSUInteger decodeCount;
+
+/** Add data that has arrived, and decode what has been received thus far, if it has grown enough since the last decode.
+ *
+ * @param data                The data that has just arrived (not all of the data received thus far).
+ * @param queue               The queue on which the `partialImageHandler` should be called. If `nil`, it will use `dispatch_get_main_queue()`.
+ * @param partialImageHandler The block called with the partially decoded image. It is not called if nothing could be decoded yet.
+ */
+
+- (void)appendData:(NSData *)data
+             queue:(dispatch_queue_t)queue
+partialImageHandler:(NetworkImageProcessorPartialImageHandler)partialImageHandler;
+
+/** Stop decoding.
+ *
+ * No partial image is delivered after this is called, even one that was already decoded (and dispatched to the
+ * `queue`), so a partial image can never arrive after, and replace, the final one. Any data appended afterwards is ignored.
+ *
+ * @return All of the data appended, which the decoder no longer uses.
+ */
+
+- (NSData *)finish;
+
+@end
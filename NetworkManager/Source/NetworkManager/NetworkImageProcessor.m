@@ -0,0 +1,336 @@
+//
+//  NetworkImageProcessor.m
+//
+//  Created by agent on 10/19/26.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+//  This work is licensed under a Creative Commons Attribution-ShareAlike 4.0 International License.
+//  http://creativecommons.org/licenses/by-sa/4.0/
+
+#import "NetworkImageProcessor.h"
+
+@import ImageIO;
+
+static CGFloat _mainScreenScale;
+
+/* An incremental decode starts only once the data has grown by at least this much (and by at least a quarter)
+ * since the last one.
+ */
+static NSUInteger const kMinimumDecodeGrowth = 4096;
+
+@interface NetworkImageProcessor ()
+
+@property (nonatomic, strong, readwrite) NSOperationQueue *decodeQueue;
+@property (nonatomic, strong) NSCache *cache;
+
+- (NSDictionary *)thumbnailOptionsWithMaximumPixelSize:(CGFloat)maximumPixelSize;
+
+@end
+
+@interface NetworkIncrementalImageDecoder ()
+
+@property (nonatomic, weak) NetworkImageProcessor *processor;
+@property (nonatomic, readwrite) CGFloat maximumPixelSize;
+@property (nonatomic) CGImageSourceRef source;
+@property (nonatomic, strong) NSMutableData *data;
+@property (nonatomic) NSUInteger decodedLength;
+@property (nonatomic, readwrite) NSUInteger decodeCount;
+@property (nonatomic, getter = isDecodePending) BOOL decodePending;
+@property (atomic, getter = isFinished) BOOL finished;
+
+- (instancetype)initWithProcessor:(NetworkImageProcessor *)processor maximumPixelSize:(CGFloat)maximumPixelSize;
+
+@end
+
+@implementation NetworkImageProcessor
+
++ (instancetype)sharedProcessor {
+    static id sharedProcessor;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        sharedProcessor = [[self alloc] init];
+    });
+    return sharedProcessor;
+}
+
+/* `UIScreen` may only be used on the main thread, so the scale is read there, once: right away if the class is
+ * first used on the main thread, otherwise as soon as the main queue gets to it. No thread ever waits on the main
+ * thread for it, since the main thread might be waiting on that thread.
+ */
++ (void)initialize {
+    if (self != [NetworkImageProcessor class])
+        return;
+
+    if ([NSThread isMainThread]) {
+        [self readMainScreenScale];
+    } else {
+        dispatch_async(dispatch_get_main_queue(), ^{
+            [self readMainScreenScale];
+        });
+    }
+}
+
++ (void)readMainScreenScale {
+    CGFloat scale = [[UIScreen mainScreen] scale];
+
+    @synchronized([NetworkImageProcessor class]) {
+        _mainScreenScale = scale;
+    }
+}
+
+/* The main screen's scale, or zero if it hasn't been read yet.
+ */
++ (CGFloat)mainScreenScale {
+    @synchronized([NetworkImageProcessor class]) {
+        return _mainScreenScale;
+    }
+}
+
+- (instancetype)init {
+    CGFloat scale = [[self class] mainScreenScale];
+
+    NSAssert(scale > 0, @"%s: the main screen's scale hasn't been read yet; create the first processor on the main thread, or use initWithImageScale:", __FUNCTION__);
+
+    return [self initWithImageScale:scale > 0 ? scale : 1.0];
+}
+
+- (instancetype)initWithImageScale:(CGFloat)imageScale {
+    self = [super init];
+    if (self) {
+        _decodeQueue = [[NSOperationQueue alloc] init];
+        _decodeQueue.name = [NSString stringWithFormat:@"%@.NetworkImageProcessor.%p", [[NSBundle mainBundle] bundleIdentifier], self];
+        _decodeQueue.maxConcurrentOperationCount = 2;
+
+        _cache = [[NSCache alloc] init];
+        self.cacheCostLimit = 32 * 1024 * 1024;
+
+        _imageScale = imageScale;
+    }
+    return self;
+}
+
+- (void)setCacheCostLimit:(NSUInteger)cacheCostLimit {
+    _cacheCostLimit = cacheCostLimit;
+    self.cache.totalCostLimit = cacheCostLimit;
+}
+
+#pragma mark - Processing
+
+- (void)processImageData:(NSData *)data
+                  forURL:(NSURL *)url
+        maximumPixelSize:(CGFloat)maximumPixelSize
+                   queue:(dispatch_queue_t)queue
+       completionHandler:(NetworkImageProcessorCompletionHandler)completionHandler {
+    NSParameterAssert(completionHandler);
+
+    [self.decodeQueue addOperationWithBlock:^{
+        CGImageSourceRef source = data ? CGImageSourceCreateWithData((__bridge CFDataRef)data, (__bridge CFDictionaryRef)[self sourceOptions]) : NULL;
+        [self completeWithImageSource:source url:url maximumPixelSize:maximumPixelSize queue:queue completionHandler:completionHandler];
+    }];
+}
+
+- (void)processImageFileURL:(NSURL *)fileURL
+                     forURL:(NSURL *)url
+           maximumPixelSize:(CGFloat)maximumPixelSize
+                      queue:(dispatch_queue_t)queue
+          completionHandler:(NetworkImageProcessorCompletionHandler)completionHandler {
+    NSParameterAssert(completionHandler);
+
+    [self.decodeQueue addOperationWithBlock:^{
+        // ImageIO reads the file as it decodes, so the encoded image is never loaded into memory in its entirety
+
+        CGImageSourceRef source = fileURL ? CGImageSourceCreateWithURL((__bridge CFURLRef)fileURL, (__bridge CFDictionaryRef)[self sourceOptions]) : NULL;
+        [self completeWithImageSource:source url:url maximumPixelSize:maximumPixelSize queue:queue completionHandler:completionHandler];
+    }];
+}
+
+- (NSDictionary *)sourceOptions {
+    // don't cache the full size decoded image; we only want the thumbnail
+
+    return @{(__bridge NSString *)kCGImageSourceShouldCache: @NO};
+}
+
+/* Create the downsampled image (if we can), cache it, and call the completion handler.
+ *
+ * This consumes (i.e. releases) the `source`.
+ */
+- (void)completeWithImageSource:(CGImageSourceRef)source
+                            url:(NSURL *)url
+               maximumPixelSize:(CGFloat)maximumPixelSize
+                          queue:(dispatch_queue_t)queue
+              completionHandler:(NetworkImageProcessorCompletionHandler)completionHandler {
+    UIImage *image;
+    NSError *error;
+
+    if (source) {
+        CGImageRef imageRef = CGImageSourceCreateThumbnailAtIndex(source, 0, (__bridge CFDictionaryRef)[self thumbnailOptionsWithMaximumPixelSize:maximumPixelSize]);
+        if (imageRef) {
+            image = [UIImage imageWithCGImage:imageRef scale:self.imageScale orientation:UIImageOrientationUp];
+
+            NSUInteger cost = CGImageGetBytesPerRow(imageRef) * CGImageGetHeight(imageRef);
+            NSString *key = [self cacheKeyForURL:url maximumPixelSize:maximumPixelSize];
+            if (key)
+                [self.cache setObject:image forKey:key cost:cost];
+
+            CGImageRelease(imageRef);
+        }
+
+        CFRelease(source);
+    }
+
+    if (!image) {
+        error = [NSError errorWithDomain:NSURLErrorDomain code:NSURLErrorCannotDecodeContentData userInfo:url ? @{NSURLErrorKey: url} : nil];
+    }
+
+    dispatch_async(queue ?: dispatch_get_main_queue(), ^{
+        completionHandler(image, error);
+    });
+}
+
+- (NSDictionary *)thumbnailOptionsWithMaximumPixelSize:(CGFloat)maximumPixelSize {
+    return @{(__bridge NSString *)kCGImageSourceCreateThumbnailFromImageAlways : @YES,
+             (__bridge NSString *)kCGImageSourceCreateThumbnailWithTransform   : @YES,
+             (__bridge NSString *)kCGImageSourceShouldCacheImmediately          : @YES,
+             (__bridge NSString *)kCGImageSourceThumbnailMaxPixelSize           : @(maximumPixelSize)};
+}
+
+- (NetworkIncrementalImageDecoder *)incrementalDecoderWithMaximumPixelSize:(CGFloat)maximumPixelSize {
+    return [[NetworkIncrementalImageDecoder alloc] initWithProcessor:self maximumPixelSize:maximumPixelSize];
+}
+
+#pragma mark - Cache
+
+- (NSString *)cacheKeyForURL:(NSURL *)url maximumPixelSize:(CGFloat)maximumPixelSize {
+    if (!url)
+        return nil;
+
+    return [NSString stringWithFormat:@"%@#%.0f", [url absoluteString], maximumPixelSize];
+}
+
+- (UIImage *)cachedImageForURL:(NSURL *)url maximumPixelSize:(CGFloat)maximumPixelSize {
+    NSString *key = [self cacheKeyForURL:url maximumPixelSize:maximumPixelSize];
+
+    return key ? [self.cache objectForKey:key] : nil;
+}
+
+- (void)removeAllCachedImages {
+    [self.cache removeAllObjects];
+}
+
+@end
+
+
+@implementation NetworkIncrementalImageDecoder
+
+- (instancetype)initWithProcessor:(NetworkImageProcessor *)processor maximumPixelSize:(CGFloat)maximumPixelSize {
+    self = [super init];
+    if (self) {
+        _processor = processor;
+        _maximumPixelSize = maximumPixelSize;
+        _source = CGImageSourceCreateIncremental((__bridge CFDictionaryRef)@{(__bridge NSString *)kCGImageSourceShouldCache: @NO});
+        _data = [[NSMutableData alloc] init];
+    }
+    return self;
+}
+
+- (void)dealloc {
+    if (_source)
+        CFRelease(_source);
+}
+
+- (void)appendData:(NSData *)data
+             queue:(dispatch_queue_t)queue
+partialImageHandler:(NetworkImageProcessorPartialImageHandler)partialImageHandler {
+    NSParameterAssert(partialImageHandler);
+
+    NetworkImageProcessor *processor = self.processor;
+
+    @synchronized(self) {
+        if ([self isFinished])
+            return;
+
+        [self.data appendData:data];
+
+        // if a decode is already waiting, it will pick up this data, so there's no need for another
+
+        if (!processor || [self isDecodePending] || ![self shouldDecode])
+            return;
+
+        self.decodePending = YES;
+    }
+
+    // one operation decodes until it has caught up with the data, so the incremental source is only ever used by one thread at a time
+
+    [processor.decodeQueue addOperationWithBlock:^{
+        while (YES) {
+            NSData *snapshot;
+
+            // the data is only copied here, once per decode, and decodes are spaced out geometrically, so the
+            // bytes copied over the whole response stay proportional to its size
+
+            @synchronized(self) {
+                if ([self isFinished] || ![self shouldDecode]) {
+                    self.decodePending = NO;
+                    return;
+                }
+
+                snapshot = [self.data copy];
+                self.decodedLength = [snapshot length];
+                self.decodeCount++;
+            }
+
+            UIImage *image = [self partialImageWithData:snapshot processor:processor];
+            if (image) {
+                dispatch_async(queue ?: dispatch_get_main_queue(), ^{
+                    // once finished, the final image is on its way, and a partial one must not replace it
+
+                    if (![self isFinished])
+                        partialImageHandler(image);
+                });
+            }
+        }
+    }];
+}
+
+- (NSData *)finish {
+    @synchronized(self) {
+        self.finished = YES;
+
+        NSData *data = self.data;
+        self.data = nil;
+
+        return data;
+    }
+}
+
+/* Whether the data has grown enough since the last decode to be worth decoding again. Called while synchronized.
+ */
+- (BOOL)shouldDecode {
+    NSUInteger length = [self.data length];
+
+    return length > self.decodedLength && length - self.decodedLength >= MAX(kMinimumDecodeGrowth, self.decodedLength / 4);
+}
+
+/* Update the incremental source and create a thumbnail of what can be decoded so far.
+ */
+- (UIImage *)partialImageWithData:(NSData *)data processor:(NetworkImageProcessor *)processor {
+    if (!self.source)
+        return nil;
+
+    CGImageSourceUpdateData(self.source, (__bridge CFDataRef)data, false);
+
+    CGImageSourceStatus status = CGImageSourceGetStatusAtIndex(self.source, 0);
+    if (status != kCGImageStatusIncomplete && status != kCGImageStatusComplete)
+        return nil;
+
+    CGImageRef imageRef = CGImageSourceCreateThumbnailAtIndex(self.source, 0, (__bridge CFDictionaryRef)[processor thumbnailOptionsWithMaximumPixelSize:self.maximumPixelSize]);
+    if (!imageRef)
+        return nil;
+
+    UIImage *image = [UIImage imageWithCGImage:imageRef scale:processor.imageScale orientation:UIImageOrientationUp];
+    CGImageRelease(imageRef);
+
+    return image;
+}
+
+@end
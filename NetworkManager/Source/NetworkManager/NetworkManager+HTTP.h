@@ -38,7 +38,15 @@
  * @param parameters   `NSDictionary` for parameters to add to POST request; may be `nil` if no additional parameters. This accepts `NSString`, `NSNumber`, `NSDate`, and `NSData` objects. If the object is `NSData`, it simply converts it to a UTF8 string. If `NSDate`, this creates RFC 3339 date string (with milliseconds).
  * @param completion   Block to be invoked when POST request completes (or fails).
  *
- * @return             The operation that has been started.
+ * @return             The operation that has been started. If the manager has a `requestBatcher`, this is always `nil`.
+ *
+ * @note If the manager has a `requestBatcher`, the request is sent as part of a batch, and `completion` receives the
+ *       result of this request alone. If the response is JSON, `completion` receives the parsed object along with
+ *       the request's own error (e.g. for a non-2xx status), or, failing that, any error parsing the JSON.
+ *
+ * @warning While batching, there is no operation for the request (the batch as a whole is one operation, shared
+ *          with other requests), so it can't be canceled or prioritized, and callers must not rely on the
+ *          return value: use `completion` to learn the outcome.
  */
 - (NetworkDataTaskOperation *)post:(NSURL *)url
                         parameters:(NSDictionary *)parameters
@@ -205,37 +205,58 @@
 
     [request setHTTPBody:[self createFormUrlEncodedBodyUsingParameters:parameters]];
 
+    // if batching, the request's own response is demultiplexed from the batch response
+
+    if (self.requestBatcher) {
+        [self.requestBatcher enqueueRequest:request completionHandler:^(NSHTTPURLResponse *response, NSData *data, NSError *error) {
+            [self completeWithResponse:response data:data error:error completion:completion];
+        }];
+
+        return nil;
+    }
+
     // setting the body of the post to the request
 
     NetworkDataTaskOperation *operation = [self dataOperationWithRequest:request progressHandler:nil completionHandler:^(NetworkTaskOperation *operation, NSData *data, NSError *error) {
-        NSHTTPURLResponse *response = (NSHTTPURLResponse *) operation.task.response;
-        BOOL isJSON = NO;
+        [self completeWithResponse:(NSHTTPURLResponse *)operation.task.response data:data error:error completion:completion];
+    }];
 
-        if ([response isKindOfClass:[NSHTTPURLResponse class]]) {
-            for (NSString *headerKey in response.allHeaderFields) {
-                if ([[headerKey lowercaseString] isEqualToString:@"content-type"]) {
-                    if ([[response.allHeaderFields[headerKey] lowercaseString] isEqualToString:@"application/json"])
-                        isJSON = YES;
-                }
-            }
-        }
+    [self addOperation:operation];
 
-        if (completion) {
-            if (isJSON) {
-                NSError *parseError = nil;
-                id object = [NSJSONSerialization JSONObjectWithData:data options:0 error:&parseError];
-                completion(object, parseError);
-            } else {
-                completion(data, error);
+    return operation;
+}
+
+/* Call the completion block of `post:parameters:completion:`, parsing the response if it is JSON.
+ */
+- (void)completeWithResponse:(NSHTTPURLResponse *)response
+                        data:(NSData *)data
+                       error:(NSError *)error
+                  completion:(void (^)(id responseObject, NSError *error))completion {
+    BOOL isJSON = NO;
+
+    if ([response isKindOfClass:[NSHTTPURLResponse class]]) {
+        for (NSString *headerKey in response.allHeaderFields) {
+            if ([[headerKey lowercaseString] isEqualToString:@"content-type"]) {
+                if ([[response.allHeaderFields[headerKey] lowercaseString] isEqualToString:@"application/json"])
+                    isJSON = YES;
             }
-        } else if (error) {
-            NSLog(@"%s: %@", __PRETTY_FUNCTION__, error);
         }
-    }];
+    }
 
-    [self addOperation:operation];
+    if (completion) {
+        if (isJSON) {
+            NSError *parseError = nil;
+            id object = [NSJSONSerialization JSONObjectWithData:data options:0 error:&parseError];
 
-    return operation;
+            // a JSON body doesn't make a non-2xx response a success, so the request's own error takes precedence
+
+            completion(object, error ?: parseError);
+        } else {
+            completion(data, error);
+        }
+    } else if (error) {
+        NSLog(@"%s: %@", __PRETTY_FUNCTION__, error);
+    }
 }
 
 - (NSString *)percentEscapeString:(NSString *)string {
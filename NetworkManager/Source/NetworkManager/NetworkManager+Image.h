@@ -0,0 +1,82 @@
+//
+//  NetworkManager+Image.h
+//
+//  Created by agent on 10/19/26.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+//  This work is licensed under a Creative Commons Attribution-ShareAlike 4.0 International License.
+//  http://creativecommons.org/licenses/by-sa/4.0/
+
+#import "NetworkManager.h"
+#import "NetworkImageProcessor.h"
+
+/** Utility Methods to retrieve images that are decoded and downsampled before the completion block is called
+ */
+@interface NetworkManager (Image)
+
+/// -----------------------------------------------
+/// @name Image request utility methods
+/// -----------------------------------------------
+
+/** Prepare and initiate data task for an image, decoding and downsampling it in the background
+ *
+ * @param url              URL of the image.
+ * @param maximumPixelSize The maximum width or height, in pixels, of the resulting image.
+ * @param imageProcessor   The `<NetworkImageProcessor>` that decodes (and caches) the image; if `nil`, the shared processor is used.
+ * @param completion       Block to be invoked with the decoded image when the request and decoding are done (or either fails).
+ *                         This is called on the manager's `completionQueue` (or the main queue if that is `nil`).
+ *
+ * @return                 The operation that has been started.
+ *
+ * @note Check `cachedImageForURL:maximumPixelSize:` of the image processor before calling this method, to avoid
+ *       retrieving images that have already been decoded.
+ */
+- (NetworkDataTaskOperation *)imageDataOperationWithURL:(NSURL *)url
+                                       maximumPixelSize:(CGFloat)maximumPixelSize
+                                         imageProcessor:(NetworkImageProcessor *)imageProcessor
+                                             completion:(void (^)(UIImage *image, NSError *error))completion;
+
+/** Prepare and initiate data task for an image, decoding it progressively as it arrives
+ *
+ * As the data arrives, it is decoded incrementally (see `<NetworkIncrementalImageDecoder>`), and `partialImageHandler`
+ * is called with what has been decoded so far, e.g. a blurry first pass of a progressive JPEG. When the request is
+ * done, `completion` is called with the final image, just as with `imageDataOperationWithURL:maximumPixelSize:imageProcessor:completion:`.
+ *
+ * @param url                 URL of the image.
+ * @param maximumPixelSize    The maximum width or height, in pixels, of the resulting images.
+ * @param imageProcessor      The `<NetworkImageProcessor>` that decodes (and caches) the image; if `nil`, the shared processor is used.
+ * @param partialImageHandler Block to be invoked with each partially decoded image. Partial images are not cached.
+ * @param completion          Block to be invoked with the decoded image when the request and decoding are done (or either fails).
+ *
+ * Both blocks are called on the manager's `completionQueue` (or the main queue if that is `nil`). No partial image
+ * is delivered once the request has finished, so none can arrive after (and replace) the final image.
+ *
+ * @return                    The operation that has been started.
+ */
+- (NetworkDataTaskOperation *)imageDataOperationWithURL:(NSURL *)url
+                                       maximumPixelSize:(CGFloat)maximumPixelSize
+                                         imageProcessor:(NetworkImageProcessor *)imageProcessor
+                                    partialImageHandler:(NetworkImageProcessorPartialImageHandler)partialImageHandler
+                                             completion:(void (^)(UIImage *image, NSError *error))completion;
+
+/** Prepare and initiate download task for an image, decoding and downsampling it in the background
+ *
+ * The image is decoded directly from the downloaded file, so the encoded image is never held in memory.
+ *
+ * @param url              URL of the image.
+ * @param maximumPixelSize The maximum width or height, in pixels, of the resulting image.
+ * @param imageProcessor   The `<NetworkImageProcessor>` that decodes (and caches) the image; if `nil`, the shared processor is used.
+ * @param completion       Block to be invoked with the decoded image when the download and decoding are done (or either fails).
+ *                         This is called on the manager's `completionQueue` (or the main queue if that is `nil`).
+ *
+ * @return                 The operation that has been started.
+ *
+ * @note Check `cachedImageForURL:maximumPixelSize:` of the image processor before calling this method, to avoid
+ *       retrieving images that have already been decoded.
+ */
+- (NetworkDownloadTaskOperation *)imageDownloadOperationWithURL:(NSURL *)url
+                                               maximumPixelSize:(CGFloat)maximumPixelSize
+                                                 imageProcessor:(NetworkImageProcessor *)imageProcessor
+                                                     completion:(void (^)(UIImage *image, NSError *error))completion;
+
+@end
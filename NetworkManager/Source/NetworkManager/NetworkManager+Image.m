@@ -0,0 +1,124 @@
+//
+//  NetworkManager+Image.m
+//
+//  Created by agent on 10/19/26.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+//  This work is licensed under a Creative Commons Attribution-ShareAlike 4.0 International License.
+//  http://creativecommons.org/licenses/by-sa/4.0/
+
+#import "NetworkManager+Image.h"
+
+@implementation NetworkManager (Image)
+
+- (NetworkDataTaskOperation *)imageDataOperationWithURL:(NSURL *)url
+                                       maximumPixelSize:(CGFloat)maximumPixelSize
+                                         imageProcessor:(NetworkImageProcessor *)imageProcessor
+                                             completion:(void (^)(UIImage *image, NSError *error))completion {
+    NSParameterAssert(completion);
+
+    NetworkImageProcessor *processor = imageProcessor ?: [NetworkImageProcessor sharedProcessor];
+    dispatch_queue_t completionQueue = self.completionQueue ?: dispatch_get_main_queue();
+
+    NetworkDataTaskOperation *operation = [self dataOperationWithURL:url progressHandler:nil completionHandler:^(NetworkTaskOperation *operation, NSData *data, NSError *error) {
+        if (error) {
+            dispatch_async(completionQueue, ^{
+                completion(nil, error);
+            });
+            return;
+        }
+
+        [processor processImageData:data forURL:url maximumPixelSize:maximumPixelSize queue:completionQueue completionHandler:completion];
+    }];
+
+    // hand the data to the processor from a background queue, so the main thread isn't involved until the image is ready
+
+    operation.completionQueue = dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0);
+
+    [self addOperation:operation];
+
+    return operation;
+}
+
+- (NetworkDataTaskOperation *)imageDataOperationWithURL:(NSURL *)url
+                                       maximumPixelSize:(CGFloat)maximumPixelSize
+                                         imageProcessor:(NetworkImageProcessor *)imageProcessor
+                                    partialImageHandler:(NetworkImageProcessorPartialImageHandler)partialImageHandler
+                                             completion:(void (^)(UIImage *image, NSError *error))completion {
+    NSParameterAssert(completion);
+
+    if (!partialImageHandler)
+        return [self imageDataOperationWithURL:url maximumPixelSize:maximumPixelSize imageProcessor:imageProcessor completion:completion];
+
+    NetworkImageProcessor *processor = imageProcessor ?: [NetworkImageProcessor sharedProcessor];
+    dispatch_queue_t completionQueue = self.completionQueue ?: dispatch_get_main_queue();
+    NetworkIncrementalImageDecoder *decoder = [processor incrementalDecoderWithMaximumPixelSize:maximumPixelSize];
+
+    NetworkDataTaskOperation *operation = [self dataOperationWithURL:url progressHandler:nil completionHandler:^(NetworkTaskOperation *operation, NSData *data, NSError *error) {
+        // stop the partial images before the final one is decoded, so none of them can arrive after it
+
+        NSData *imageData = [decoder finish];
+
+        if (error) {
+            dispatch_async(completionQueue, ^{
+                completion(nil, error);
+            });
+            return;
+        }
+
+        [processor processImageData:imageData forURL:url maximumPixelSize:maximumPixelSize queue:completionQueue completionHandler:completion];
+    }];
+
+    // with a `didReceiveDataHandler`, the operation leaves it to us to collect the data, which the decoder does
+
+    operation.didReceiveDataHandler = ^(NetworkDataTaskOperation *operation, NSData *data, long long totalBytesExpected, long long bytesReceived) {
+        [decoder appendData:data queue:completionQueue partialImageHandler:partialImageHandler];
+    };
+
+    operation.completionQueue = dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0);
+
+    [self addOperation:operation];
+
+    return operation;
+}
+
+- (NetworkDownloadTaskOperation *)imageDownloadOperationWithURL:(NSURL *)url
+                                               maximumPixelSize:(CGFloat)maximumPixelSize
+                                                 imageProcessor:(NetworkImageProcessor *)imageProcessor
+                                                     completion:(void (^)(UIImage *image, NSError *error))completion {
+    NSParameterAssert(completion);
+
+    NetworkImageProcessor *processor = imageProcessor ?: [NetworkImageProcessor sharedProcessor];
+    dispatch_queue_t completionQueue = self.completionQueue ?: dispatch_get_main_queue();
+
+    NetworkDownloadTaskOperation *operation = [self downloadOperationWithURL:url didWriteDataHandler:nil didFinishDownloadingHandler:^(NetworkDownloadTaskOperation *operation, NSURL *location, NSError *error) {
+        NSURL *fileURL;
+
+        // the downloaded file is deleted as soon as this block returns, so move it somewhere it will survive until it's decoded
+
+        if (!error) {
+            fileURL = [NSURL fileURLWithPath:[NSTemporaryDirectory() stringByAppendingPathComponent:[[NSUUID UUID] UUIDString]]];
+            [[NSFileManager defaultManager] moveItemAtURL:location toURL:fileURL error:&error];
+        }
+
+        if (error) {
+            dispatch_async(completionQueue, ^{
+                completion(nil, error);
+            });
+            return;
+        }
+
+        [processor processImageFileURL:fileURL forURL:url maximumPixelSize:maximumPixelSize queue:completionQueue completionHandler:^(UIImage *image, NSError *error) {
+            [[NSFileManager defaultManager] removeItemAtURL:fileURL error:nil];
+            completion(image, error);
+        }];
+    }];
+
+    operation.completionQueue = dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0);
+
+    [self addOperation:operation];
+
+    return operation;
+}
+
+@end
@@ -11,6 +11,10 @@
 #import "NetworkDataTaskOperation.h"
 #import "NetworkDownloadTaskOperation.h"
 #import "NetworkUploadTaskOperation.h"
+#import "NetworkResumableUploadTaskOperation.h"
+#import "NetworkCircuitBreaker.h"
+#import "NetworkAuthenticationCache.h"
+#import "NetworkRequestBatcher.h"
 
 extern NSString * const kNetworkManagerVersion;
 
@@ -33,6 +37,9 @@ typedef void(^DidCompleteWithError)(NetworkManager *manager,
                                     NSURLSessionTask *task,
                                     NSError *error);
 
+typedef void(^TaskOperationHandlerBinder)(NetworkManager *manager,
+                                          NetworkTaskOperation *operation);
+
 /** Network manager
 
 This creates a `NSURLSession` and manages an collection of `<NetworkTaskOperation>`
@@ -119,6 +126,10 @@ achieves task-based delegate calls.
 /** The block that will be called by `URLSession:downloadTask:didFinishDownloadingToURL:`.
  Generally we keep the task methods at the task operation class level, but for background
  downloads, we may lose the operations when the app is killed.
+
+ This is called for any download whose operation has no `didFinishDownloadingHandler`. If the operation has a
+ `destinationURL`, `location` is that URL, unless the file couldn't be moved there (in which case it is where the
+ session left the file, and the move's error is reported to `didCompleteWithError`).
  
  This uses the following typedef:
  
@@ -154,6 +165,71 @@ achieves task-based delegate calls.
  */
 @property (nonatomic, strong) dispatch_queue_t completionQueue;
 
+/** The maximum number of hedge tasks, expressed as a fraction of the hedged requests added to this manager's queue.
+ *
+ * For example, the default of `0.1` means that no more than one in ten hedged requests will actually
+ * start a duplicate task. This caps the extra load that hedging places upon the server.
+ *
+ * The budget is rounded up, so the first hedged request may start a hedge, and the next hedge is
+ * available once the eleventh hedged request has been added. A hedged operation that is created but never
+ * passed to `<addOperation:>` doesn't count.
+ */
+@property (nonatomic) double hedgeBudget;
+
+/** The hedge delay used for a host until enough responses from it have been observed to estimate its 95th percentile latency.
+ *
+ * The default is one second.
+ */
+@property (nonatomic) NSTimeInterval defaultHedgeDelay;
+
+
+/** Lifecycle tracer. Default is `nil`, meaning that nothing is traced.
+ *
+ * If set, every operation subsequently created by this manager records its queueing, task, response and handler
+ * spans to the tracer, which can then export them in Chrome trace-event format.
+ */
+@property (nonatomic, strong) NetworkTracer *tracer;
+
+/** Per-host circuit breaker. Default is `nil`, meaning that no circuit breaking is performed.
+ *
+ * If set, the outcome of every task is reported to the breaker, and `<addOperation:>` will immediately fail
+ * (without queuing) any `<NetworkTaskOperation>` whose host's circuit is open. Its completion handler is
+ * called with a `kNetworkCircuitBreakerErrorDomain` error. Use the breaker's `hostStates` for monitoring.
+ */
+@property (nonatomic, strong) NetworkCircuitBreaker *circuitBreaker;
+
+/** Authentication decision cache. Default is `nil`, meaning that every challenge goes to a challenge handler.
+ *
+ * If set, a challenge for a protection space for which a decision has been cached is answered right away, on the
+ * session's delegate queue, rather than waiting for a handler on the `completionQueue` (which is the main queue by default).
+ * Otherwise, the challenge handlers are called as usual, and their decision is cached. This applies to both the manager's
+ * `didReceiveChallenge` (and `credential`) and the operations' `didReceiveChallengeHandler`.
+ *
+ * Since decisions are cached by protection space, a decision made by one operation's `didReceiveChallengeHandler`,
+ * including a decision to trust a server's certificate, is then used for every operation with the same protection space.
+ *
+ * If there is a `<tracer>`, every challenge records a `challenge` span (or a `challenge (cached)` span for a hit),
+ * measuring how long the connection waited for the decision.
+ */
+@property (nonatomic, strong) NetworkAuthenticationCache *authenticationCache;
+
+/** Memory monitor. Default is `nil`, meaning that memory is neither accounted for nor shed.
+ *
+ * If set, every operation subsequently created by this manager reports the bytes held by its response buffer, and
+ * `<addOperation:>` reports the bodies of the operations it queues. When usage exceeds the monitor's watermark, or the
+ * system reports memory pressure, large in-progress responses are spilled to disk, then `bulk` operations are paused,
+ * and finally new `bulk` operations are rejected (their completion handler is called with a
+ * `kNetworkMemoryMonitorErrorDomain` error). Use the monitor's metrics properties for monitoring.
+ */
+@property (nonatomic, strong) NetworkMemoryMonitor *memoryMonitor;
+
+/** Request batcher. Default is `nil`, meaning that every request is sent by itself.
+ *
+ * If set, the `NetworkManager (HTTP)` method `post:parameters:completion:` sends its requests through the
+ * batcher, which combines requests to the same origin, made within a short window, into a single batch request.
+ */
+@property (nonatomic, strong) NetworkRequestBatcher *requestBatcher;
+
 
 /// ----------------------------
 /// @name Initialization methods
@@ -167,7 +243,36 @@ achieves task-based delegate calls.
  */
 - (instancetype)initWithSessionConfiguration:(NSURLSessionConfiguration *)configuration;
 
+/** Create session manager using the supplied NSURLSessionConfiguration, setting it up before its session is created
+ *
+ * For a background configuration, the session may start delivering events (and reporting which of the restored
+ * tasks are gone) as soon as it is created, so anything that should receive them, i.e. the handler binders
+ * and the manager-level handlers (e.g. `didCompleteWithError`), must be set in the `setupHandler`.
+ *
+ * @param configuration The NSURLSessionConfiguration for the underlying NSURLSession.
+ * @param setupHandler  Block called with the manager (after any operations have been restored, but before the session is created), to register binders and set handlers.
+ *
+ * @return A session manager.
+ */
+- (instancetype)initWithSessionConfiguration:(NSURLSessionConfiguration *)configuration setupHandler:(void (^)(NetworkManager *manager))setupHandler;
+
 /** Retrieve (and, if necessary create) background session manager
+ *
+ * When the manager is created (e.g. when the app is relaunched to handle background session events),
+ * the tasks it had started in a previous launch are restored from a compact record it keeps on disk
+ * (the task identifier, class of operation, `purpose`, `handlerKey` and, for downloads, `destinationURL`).
+ * A lightweight operation is registered for each before the session can deliver any events, so those
+ * events are routed to it, and its handlers are attached lazily, when its first event arrives, by the binder
+ * registered for its `handlerKey` (see `<registerHandlerBinder:forKey:>`).
+ *
+ * Once the session has reported its tasks, any restored operation whose task it no longer has is removed
+ * (with its record) and canceled with an `NSURLErrorCancelled` error, which is delivered just as a failure of its task
+ * would be: to its `didCompleteWithDataErrorHandler` or, for a download, `didFinishDownloadingHandler` (if a binder
+ * has been registered for it), or else to the manager's `didCompleteWithError` (with a `nil` task). It is then removed
+ * from `<restoredOperations>`.
+ *
+ * The session may report its tasks before this method even returns, so binders and handlers registered afterwards
+ * may miss those reports. Use `<backgroundSessionWithIdentifier:setupHandler:>` to register them in time.
  *
  * @param identifier Background session identifier
  *
@@ -175,6 +280,20 @@ achieves task-based delegate calls.
  */
 + (instancetype) backgroundSessionWithIdentifier:(NSString *)identifier;
 
+/** Retrieve (and, if necessary create) background session manager, setting it up before its session is created
+ *
+ * This is `<backgroundSessionWithIdentifier:>`, except that, when the manager is created, `setupHandler` is called
+ * before its session is (see `<initWithSessionConfiguration:setupHandler:>`), so the binders it registers (see
+ * `<registerHandlerBinder:forKey:>`) and the manager-level handlers it sets are in place for every event of the
+ * restored tasks, including the failure of those that were lost.
+ *
+ * @param identifier   Background session identifier
+ * @param setupHandler Block that registers binders and sets handlers. It is not called if the manager already exists.
+ *
+ * @return A session manager.
+ */
++ (instancetype) backgroundSessionWithIdentifier:(NSString *)identifier setupHandler:(void (^)(NetworkManager *manager))setupHandler;
+
 /// -----------------------------------------------
 /// @name NetworkTaskOperation factory methods
 /// -----------------------------------------------
@@ -217,6 +336,28 @@ achieves task-based delegate calls.
                                    progressHandler:(ProgressHandler)progressHandler
                                  completionHandler:(DidCompleteWithDataErrorHandler)didCompleteWithDataErrorHandler;
 
+/** Create hedged data task operation.
+ *
+ * If no response is received within `hedgeDelay`, a second, identical task is started. The first task to
+ * receive a response wins and the other is canceled. Either way, the handlers are called once, as
+ * though there had been a single task.
+ *
+ * @param request The `NSURLRequest`. Only idempotent requests (e.g. `GET`, `HEAD`, `PUT`, `DELETE`) without
+ *                an `HTTPBodyStream` are hedged; for any other request, this returns a regular data task operation.
+ * @param hedgeDelay The number of seconds to wait for a response before starting the hedge. If zero,
+ *                it will use `<hedgeDelayForHost:>` for the host of the request.
+ * @param progressHandler The method that will be called with as the data is being downloaded.
+ * @param didCompleteWithDataErrorHandler The block that will be called when the request is done.
+ *
+ * @return Returns `NetworkDataTaskOperation`.
+ *
+ * @note No hedge is started if doing so would exceed the `<hedgeBudget>`.
+ */
+- (NetworkDataTaskOperation *)dataOperationWithRequest:(NSURLRequest *)request
+                                            hedgeDelay:(NSTimeInterval)hedgeDelay
+                                       progressHandler:(ProgressHandler)progressHandler
+                                     completionHandler:(DidCompleteWithDataErrorHandler)didCompleteWithDataErrorHandler;
+
 /** Create download task operation.
  *
  * @param request The `NSURLRequest`.
@@ -337,6 +478,46 @@ achieves task-based delegate calls.
                                 didSendBodyDataHandler:(DidSendBodyDataHandler)didSendBodyDataHandler
                        didCompleteWithDataErrorHandler:(DidCompleteWithDataErrorHandler)didCompleteWithDataErrorHandler;
 
+/** Create resumable upload task operation.
+ *
+ * @param request The `NSURLRequest` whose URL is the upload creation endpoint. Its headers (e.g. authorization) are included in every chunk request.
+ * @param fileURL The URL of the file to be uploaded
+ * @param didSendBodyDataHandler The method that will be called with periodic updates of the aggregate progress of all chunks
+ * @param didCompleteWithDataErrorHandler The block that will be called when the whole file has been uploaded (or the upload fails).
+ *
+ * @return Returns `NetworkResumableUploadTaskOperation`.
+ *
+ * @note The progress/completion blocks will, by default, be called on the main queue. If you want
+ *       to use a different GCD queue, specify a non-nil `<completionQueue>` value.
+ *
+ * @see NetworkResumableUploadTaskOperation
+ */
+
+- (NetworkResumableUploadTaskOperation *)resumableUploadOperationWithRequest:(NSURLRequest *)request
+                                                                     fileURL:(NSURL *)fileURL
+                                                      didSendBodyDataHandler:(DidSendBodyDataHandler)didSendBodyDataHandler
+                                             didCompleteWithDataErrorHandler:(DidCompleteWithDataErrorHandler)didCompleteWithDataErrorHandler;
+
+/** Create resumable upload task operation.
+ *
+ * @param url     The NSURL of the upload creation endpoint.
+ * @param fileURL The URL of the file to be uploaded
+ * @param didSendBodyDataHandler The method that will be called with periodic updates of the aggregate progress of all chunks
+ * @param didCompleteWithDataErrorHandler The block that will be called when the whole file has been uploaded (or the upload fails).
+ *
+ * @return Returns `NetworkResumableUploadTaskOperation`.
+ *
+ * @note The progress/completion blocks will, by default, be called on the main queue. If you want
+ *       to use a different GCD queue, specify a non-nil `<completionQueue>` value.
+ *
+ * @see NetworkResumableUploadTaskOperation
+ */
+
+- (NetworkResumableUploadTaskOperation *)resumableUploadOperationWithURL:(NSURL *)url
+                                                                 fileURL:(NSURL *)fileURL
+                                                  didSendBodyDataHandler:(DidSendBodyDataHandler)didSendBodyDataHandler
+                                         didCompleteWithDataErrorHandler:(DidCompleteWithDataErrorHandler)didCompleteWithDataErrorHandler;
+
 /// -----------------------------------------------
 /// @name NSOperationQueue utility methods
 /// -----------------------------------------------
@@ -356,8 +537,60 @@ achieves task-based delegate calls.
  * A convenience method to add operation to the network manager's `networkQueue` operation queue.
  *
  * @param operation The operation to be added to the queue.
+ *
+ * @note If there is a `<circuitBreaker>` and the circuit for the operation's host is open, or if there is a `<memoryMonitor>`
+ *       that is rejecting bulk operations and this is one, the operation is not added to the queue, but rather is canceled
+ *       with the circuit breaker's (or memory monitor's) error.
  */
 
 - (void)addOperation:(NSOperation *)operation;
 
+/// -----------------------------------------------
+/// @name Hedging
+/// -----------------------------------------------
+
+/** The observed 95th percentile response latency for a host.
+ *
+ * @param host The host name.
+ *
+ * @return The number of seconds, or `<defaultHedgeDelay>` if too few responses from this host have been observed.
+ */
+
+- (NSTimeInterval)hedgeDelayForHost:(NSString *)host;
+
+/// -----------------------------------------------
+/// @name Background session restoration
+/// -----------------------------------------------
+
+/** Register handler binder.
+ *
+ * When the first event arrives for an operation restored by a background session manager, the binder
+ * registered for that operation's `handlerKey` is called (on the session's delegate queue) to attach its
+ * handlers (e.g. `didFinishDownloadingHandler`). Until a binder is registered for it, a restored operation's
+ * events go to the manager-level handlers (e.g. `didFinishDownloadingToURL`), as they would for a task
+ * the manager knows nothing about.
+ *
+ * This uses the following typedef:
+ *
+ *     typedef void(^TaskOperationHandlerBinder)(NetworkManager *manager,
+ *                                               NetworkTaskOperation *operation);
+ *
+ * @param binder The block that attaches the handlers. If `nil`, any binder for this key is removed.
+ * @param key    The `handlerKey` of the operations this binds.
+ *
+ * @note To take effect for every event of the operations created in a previous launch, including the failure
+ *       of those whose tasks were lost, register binders in the `setupHandler` of
+ *       `<backgroundSessionWithIdentifier:setupHandler:>`, e.g. in `application:didFinishLaunchingWithOptions:`.
+ *       A binder registered later only applies to events that arrive after it is registered.
+ */
+
+- (void)registerHandlerBinder:(TaskOperationHandlerBinder)binder forKey:(NSString *)key;
+
+/** The operations restored from a previous launch that have not yet completed.
+ *
+ * @return An array of `NetworkTaskOperation` objects.
+ */
+
+- (NSArray *)restoredOperations;
+
 @end
@@ -13,6 +13,8 @@ NSString * const kNetworkManagerVersion = @"0.1";
 
 static NSMutableDictionary *_backgroundSessions;
 
+typedef void(^ChallengeCompletionHandler)(NSURLSessionAuthChallengeDisposition disposition, NSURLCredential *credential);
+
 @interface NetworkManager ()  <NSURLSessionDelegate, NSURLSessionTaskDelegate, NSURLSessionDataDelegate, NSURLSessionDownloadDelegate>
 
 @property (nonatomic, strong) NSMutableDictionary *operations;
@@ -20,8 +22,30 @@ static NSMutableDictionary *_backgroundSessions;
 @property (nonatomic, strong) NSOperationQueue *networkQueue;
 @property (nonatomic, getter = isBackgroundSession) BOOL backgroundSession;
 
+@property (nonatomic, strong) NSMutableDictionary *responseLatencies;
+@property (nonatomic) NSUInteger hedgedRequestCount;
+@property (nonatomic) NSUInteger hedgeCount;
+
+@property (nonatomic, copy) NSString *backgroundIdentifier;
+@property (nonatomic, strong) NSMutableDictionary *backgroundTaskRecords;
+@property (nonatomic, strong) NSMutableDictionary *handlerBinders;
+@property (nonatomic, strong) NSMutableSet *unboundOperations;
+@property (nonatomic, strong) NSMutableSet *restoredOperationSet;
+@property (nonatomic, strong) dispatch_queue_t recordQueue;
+
 @end
 
+static NSUInteger const kMaximumLatencySamples = 100;
+static NSUInteger const kMinimumLatencySamples = 20;
+
+static NSTimeInterval const kBackgroundTaskRecordLifetime = 7 * 24 * 60 * 60;
+
+static NSString * const kBackgroundTaskRecordClassKey       = @"class";
+static NSString * const kBackgroundTaskRecordPurposeKey     = @"purpose";
+static NSString * const kBackgroundTaskRecordHandlerKey     = @"handler";
+static NSString * const kBackgroundTaskRecordDestinationKey = @"destination";
+static NSString * const kBackgroundTaskRecordDateKey        = @"date";
+
 @implementation NetworkManager
 
 /* Create session manager with default NSURLSession.
@@ -34,17 +58,49 @@ static NSMutableDictionary *_backgroundSessions;
 }
 
 - (instancetype)initWithSessionConfiguration:(NSURLSessionConfiguration *)configuration {
+    return [self initWithSessionConfiguration:configuration setupHandler:nil];
+}
+
+- (instancetype)initWithSessionConfiguration:(NSURLSessionConfiguration *)configuration setupHandler:(void (^)(NetworkManager *manager))setupHandler {
     NSParameterAssert(configuration);
 
     self = [super init];
     if (self) {
-        _session = [NSURLSession sessionWithConfiguration:configuration delegate:self delegateQueue:nil];
         _operations = [[NSMutableDictionary alloc] init];
+        _responseLatencies = [[NSMutableDictionary alloc] init];
+        _hedgeBudget = 0.1;
+        _defaultHedgeDelay = 1.0;
+        _handlerBinders = [[NSMutableDictionary alloc] init];
+        _unboundOperations = [[NSMutableSet alloc] init];
+        _restoredOperationSet = [[NSMutableSet alloc] init];
+
+        // a background session starts delivering events for the tasks of a previous launch as soon as it is
+        // created, so the operations for those tasks must be registered before we create it
+
+        if (configuration.identifier) {
+            _backgroundIdentifier = [configuration.identifier copy];
+            _recordQueue = dispatch_queue_create("NetworkManager.backgroundTaskRecords", DISPATCH_QUEUE_SERIAL);
+            [self restoreBackgroundTaskOperations];
+        }
+
+        // likewise, the handlers (and binders) must be in place before the session can report anything to them
+
+        if (setupHandler)
+            setupHandler(self);
+
+        _session = [NSURLSession sessionWithConfiguration:configuration delegate:self delegateQueue:nil];
+
+        if (_backgroundIdentifier)
+            [self attachRestoredTasks];
     }
     return self;
 }
 
 + (instancetype) backgroundSessionWithIdentifier:(NSString *)identifier {
+    return [self backgroundSessionWithIdentifier:identifier setupHandler:nil];
+}
+
++ (instancetype) backgroundSessionWithIdentifier:(NSString *)identifier setupHandler:(void (^)(NetworkManager *manager))setupHandler {
     static dispatch_once_t onceToken;
     dispatch_once(&onceToken, ^{
         _backgroundSessions = [[NSMutableDictionary alloc] init];
@@ -72,7 +128,7 @@ static NSMutableDictionary *_backgroundSessions;
         configuration = [NSURLSessionConfiguration backgroundSessionConfiguration:identifier];
 #endif
 
-        manager = [[self alloc] initWithSessionConfiguration:configuration];
+        manager = [[self alloc] initWithSessionConfiguration:configuration setupHandler:setupHandler];
         manager.backgroundSession = YES;
         _backgroundSessions[identifier] = manager;
     }
@@ -102,8 +158,43 @@ static NSMutableDictionary *_backgroundSessions;
     operation.progressHandler = progressHandler;
     operation.didCompleteWithDataErrorHandler = didCompleteWithDataErrorHandler;
     operation.completionQueue = self.completionQueue;
+    operation.tracer = self.tracer;
+    operation.memoryMonitor = self.memoryMonitor;
+
+    [self setOperation:operation forTaskIdentifier:operation.task.taskIdentifier];
+
+    return operation;
+}
+
+- (NetworkDataTaskOperation *)dataOperationWithRequest:(NSURLRequest *)request
+                                            hedgeDelay:(NSTimeInterval)hedgeDelay
+                                       progressHandler:(ProgressHandler)progressHandler
+                                     completionHandler:(DidCompleteWithDataErrorHandler)didCompleteWithDataErrorHandler {
+    NSParameterAssert(request);
+
+    NetworkDataTaskOperation *operation;
+
+    operation = [self dataOperationWithRequest:request
+                               progressHandler:progressHandler
+                             completionHandler:didCompleteWithDataErrorHandler];
+
+    if (![self canHedgeRequest:request])
+        return operation;
+
+    operation.hedgeDelay = hedgeDelay > 0 ? hedgeDelay : [self hedgeDelayForHost:request.URL.host];
+
+    __weak NetworkManager *weakSelf = self;
+    operation.hedgeTaskProvider = ^NSURLSessionDataTask *(NetworkDataTaskOperation *operation, NSURLRequest *request) {
+        NetworkManager *strongSelf = weakSelf;
+        if (!strongSelf || ![strongSelf reserveHedge])
+            return nil;
+
+        // this is called from the hedge timer, so register the task the same way the factory methods do, under the `operations` lock
 
-    [self.operations setObject:operation forKey:@(operation.task.taskIdentifier)];
+        NSURLSessionDataTask *task = [strongSelf.session dataTaskWithRequest:request];
+        [strongSelf setOperation:operation forTaskIdentifier:task.taskIdentifier];
+        return task;
+    };
 
     return operation;
 }
@@ -136,8 +227,10 @@ static NSMutableDictionary *_backgroundSessions;
     operation.didFinishDownloadingHandler = didFinishDownloadingHandler;
     operation.didWriteDataHandler = didWriteDataHandler;
     operation.completionQueue = self.completionQueue;
+    operation.tracer = self.tracer;
+    operation.memoryMonitor = self.memoryMonitor;
 
-    [self.operations setObject:operation forKey:@(operation.task.taskIdentifier)];
+    [self setOperation:operation forTaskIdentifier:operation.task.taskIdentifier];
 
     return operation;
 }
@@ -154,8 +247,10 @@ static NSMutableDictionary *_backgroundSessions;
     operation.didFinishDownloadingHandler = didFinishDownloadingHandler;
     operation.didWriteDataHandler = didWriteDataHandler;
     operation.completionQueue = self.completionQueue;
+    operation.tracer = self.tracer;
+    operation.memoryMonitor = self.memoryMonitor;
 
-    [self.operations setObject:operation forKey:@(operation.task.taskIdentifier)];
+    [self setOperation:operation forTaskIdentifier:operation.task.taskIdentifier];
 
     return operation;
 }
@@ -190,8 +285,10 @@ static NSMutableDictionary *_backgroundSessions;
     operation.didCompleteWithDataErrorHandler = didCompleteWithDataErrorHandler;
     operation.didSendBodyDataHandler = didSendBodyDataHandler;
     operation.completionQueue = self.completionQueue;
+    operation.tracer = self.tracer;
+    operation.memoryMonitor = self.memoryMonitor;
 
-    [self.operations setObject:operation forKey:@(operation.task.taskIdentifier)];
+    [self setOperation:operation forTaskIdentifier:operation.task.taskIdentifier];
 
     return operation;
 }
@@ -221,8 +318,43 @@ static NSMutableDictionary *_backgroundSessions;
     operation.didCompleteWithDataErrorHandler = didCompleteWithDataErrorHandler;
     operation.didSendBodyDataHandler = didSendBodyDataHandler;
     operation.completionQueue = self.completionQueue;
+    operation.tracer = self.tracer;
+    operation.memoryMonitor = self.memoryMonitor;
 
-    [self.operations setObject:operation forKey:@(operation.task.taskIdentifier)];
+    [self setOperation:operation forTaskIdentifier:operation.task.taskIdentifier];
+
+    return operation;
+}
+
+- (NetworkResumableUploadTaskOperation *)resumableUploadOperationWithURL:(NSURL *)url
+                                                                 fileURL:(NSURL *)fileURL
+                                                  didSendBodyDataHandler:(DidSendBodyDataHandler)didSendBodyDataHandler
+                                         didCompleteWithDataErrorHandler:(DidCompleteWithDataErrorHandler)didCompleteWithDataErrorHandler {
+    NSParameterAssert(url);
+
+    return [self resumableUploadOperationWithRequest:[NSURLRequest requestWithURL:url]
+                                             fileURL:fileURL
+                              didSendBodyDataHandler:didSendBodyDataHandler
+                     didCompleteWithDataErrorHandler:didCompleteWithDataErrorHandler];
+}
+
+- (NetworkResumableUploadTaskOperation *)resumableUploadOperationWithRequest:(NSURLRequest *)request
+                                                                     fileURL:(NSURL *)fileURL
+                                                      didSendBodyDataHandler:(DidSendBodyDataHandler)didSendBodyDataHandler
+                                             didCompleteWithDataErrorHandler:(DidCompleteWithDataErrorHandler)didCompleteWithDataErrorHandler {
+    NSParameterAssert(request);
+    NSParameterAssert(fileURL);
+
+    NetworkResumableUploadTaskOperation *operation;
+
+    // this operation isn't tied to a single task, so it isn't added to `operations`; its chunk operations are
+
+    operation = [[NetworkResumableUploadTaskOperation alloc] initWithManager:self request:request fileURL:fileURL];
+    NSAssert(operation, @"%s: instantiation of NetworkResumableUploadTaskOperation failed", __FUNCTION__);
+    operation.didCompleteWithDataErrorHandler = didCompleteWithDataErrorHandler;
+    operation.didSendBodyDataHandler = didSendBodyDataHandler;
+    operation.completionQueue = self.completionQueue;
+    operation.tracer = self.tracer;
 
     return operation;
 }
@@ -243,9 +375,375 @@ static NSMutableDictionary *_backgroundSessions;
 }
 
 - (void)addOperation:(NSOperation *)operation {
+    if (self.tracer && [operation isKindOfClass:[NetworkTaskOperation class]]) {
+        [(NetworkTaskOperation *)operation setTraceEnqueueTime:NetworkTracerNow()];
+    }
+
+    if (self.circuitBreaker && [operation isKindOfClass:[NetworkTaskOperation class]]) {
+        NetworkTaskOperation *taskOperation = (NetworkTaskOperation *)operation;
+        NSError *error;
+
+        // fail fast, rather than tying up a slot in the queue waiting for a host we know to be down
+
+        if (![self.circuitBreaker shouldAllowTask:taskOperation.task error:&error]) {
+            [taskOperation cancelWithError:error];
+            return;
+        }
+
+        // if it was admitted as a probe, the operation frees the slot when it finishes, even if its task never runs
+
+        taskOperation.circuitBreaker = self.circuitBreaker;
+    }
+
+    if (self.memoryMonitor && [operation isKindOfClass:[NetworkTaskOperation class]]) {
+        NetworkTaskOperation *taskOperation = (NetworkTaskOperation *)operation;
+        NSError *error;
+
+        if (![self.memoryMonitor shouldAcceptOperation:taskOperation error:&error]) {
+            [self.circuitBreaker releaseProbeSlotOfTask:taskOperation.task];
+            [taskOperation cancelWithError:error];
+            return;
+        }
+
+        int64_t bodyLength = [taskOperation isKindOfClass:[NetworkUploadTaskOperation class]] ? [(NetworkUploadTaskOperation *)taskOperation bodyLength] : (int64_t)[taskOperation.task.originalRequest.HTTPBody length];
+        if (bodyLength > 0)
+            [self.memoryMonitor operation:taskOperation didAddBytes:bodyLength category:NetworkMemoryCategoryQueuedBody];
+    }
+
+    // a hedged request counts towards the hedge budget once it is actually queued, not when it is created
+
+    if ([operation isKindOfClass:[NetworkDataTaskOperation class]] && [(NetworkDataTaskOperation *)operation hedgeTaskProvider]) {
+        @synchronized(self) {
+            self.hedgedRequestCount++;
+        }
+    }
+
+    if (self.backgroundIdentifier && [operation isKindOfClass:[NetworkTaskOperation class]]) {
+        [self saveRecordForTaskOperation:(NetworkTaskOperation *)operation];
+    }
+
     [self.networkQueue addOperation:operation];
 }
 
+#pragma mark - Task operations
+
+/* `operations` is updated by the factory methods (on the caller's thread), by the hedge timer, and by the
+ * session's delegate queue, so all access to it goes through these methods, which synchronize on it.
+ */
+
+- (void)setOperation:(NetworkTaskOperation *)operation forTaskIdentifier:(NSUInteger)taskIdentifier {
+    @synchronized(self.operations) {
+        self.operations[@(taskIdentifier)] = operation;
+    }
+}
+
+- (NetworkTaskOperation *)registeredOperationForTaskIdentifier:(NSUInteger)taskIdentifier {
+    @synchronized(self.operations) {
+        return self.operations[@(taskIdentifier)];
+    }
+}
+
+- (NetworkTaskOperation *)removeOperationForTaskIdentifier:(NSUInteger)taskIdentifier {
+    @synchronized(self.operations) {
+        NetworkTaskOperation *operation = self.operations[@(taskIdentifier)];
+        [self.operations removeObjectForKey:@(taskIdentifier)];
+        return operation;
+    }
+}
+
+#pragma mark - Hedging
+
+- (BOOL)canHedgeRequest:(NSURLRequest *)request {
+    if (request.HTTPBodyStream)
+        return NO;
+
+    NSString *method = [request.HTTPMethod uppercaseString] ?: @"GET";
+
+    return [@[@"GET", @"HEAD", @"OPTIONS", @"PUT", @"DELETE", @"TRACE"] containsObject:method];
+}
+
+/* The budget is rounded up, so that the first hedged request can be hedged, rather than having to wait
+ * for `1 / hedgeBudget` hedged requests to have been added before any hedging happens at all.
+ */
+- (BOOL)reserveHedge {
+    @synchronized(self) {
+        if (self.hedgeCount >= ceil(self.hedgeBudget * self.hedgedRequestCount))
+            return NO;
+
+        self.hedgeCount++;
+        return YES;
+    }
+}
+
+- (void)recordResponseLatency:(NSTimeInterval)latency forHost:(NSString *)host {
+    if (!host)
+        return;
+
+    @synchronized(self.responseLatencies) {
+        NSMutableArray *samples = self.responseLatencies[host];
+        if (!samples) {
+            samples = [NSMutableArray array];
+            self.responseLatencies[host] = samples;
+        }
+        [samples addObject:@(latency)];
+        if ([samples count] > kMaximumLatencySamples)
+            [samples removeObjectAtIndex:0];
+    }
+}
+
+- (NSTimeInterval)hedgeDelayForHost:(NSString *)host {
+    NSArray *samples;
+
+    @synchronized(self.responseLatencies) {
+        samples = host ? [self.responseLatencies[host] copy] : nil;
+    }
+
+    if ([samples count] < kMinimumLatencySamples)
+        return self.defaultHedgeDelay;
+
+    NSArray *sorted = [samples sortedArrayUsingSelector:@selector(compare:)];
+    NSUInteger index = MIN([sorted count] - 1, (NSUInteger)ceil(0.95 * [sorted count]) - 1);
+
+    return [sorted[index] doubleValue];
+}
+
+#pragma mark - Background session restoration
+
+- (NSURL *)backgroundTaskRecordsURL {
+    NSFileManager *fileManager = [NSFileManager defaultManager];
+    NSURL *applicationSupportURL = [[fileManager URLsForDirectory:NSApplicationSupportDirectory inDomains:NSUserDomainMask] firstObject];
+    NSURL *folderURL = [applicationSupportURL URLByAppendingPathComponent:@"NetworkBackgroundTasks"];
+
+    [fileManager createDirectoryAtURL:folderURL withIntermediateDirectories:YES attributes:nil error:nil];
+
+    NSString *filename = [[self.backgroundIdentifier stringByReplacingOccurrencesOfString:@"/" withString:@"_"] stringByAppendingPathExtension:@"plist"];
+
+    return [folderURL URLByAppendingPathComponent:filename];
+}
+
+- (void)writeBackgroundTaskRecords {
+    NSDictionary *records;
+
+    @synchronized(self.backgroundTaskRecords) {
+        records = [self.backgroundTaskRecords copy];
+    }
+
+    // write asynchronously (but in order), so that creating and completing tasks never waits on the disk
+
+    dispatch_async(self.recordQueue, ^{
+        [records writeToURL:[self backgroundTaskRecordsURL] atomically:YES];
+    });
+}
+
+- (void)saveRecordForTaskOperation:(NetworkTaskOperation *)operation {
+    if (!operation.task)
+        return;
+
+    NSMutableDictionary *record = [NSMutableDictionary dictionary];
+    record[kBackgroundTaskRecordClassKey] = NSStringFromClass([operation class]);
+    record[kBackgroundTaskRecordDateKey] = @([NSDate timeIntervalSinceReferenceDate]);
+    if (operation.purpose)
+        record[kBackgroundTaskRecordPurposeKey] = operation.purpose;
+    if (operation.handlerKey)
+        record[kBackgroundTaskRecordHandlerKey] = operation.handlerKey;
+    if ([operation isKindOfClass:[NetworkDownloadTaskOperation class]] && [(NetworkDownloadTaskOperation *)operation destinationURL])
+        record[kBackgroundTaskRecordDestinationKey] = [[(NetworkDownloadTaskOperation *)operation destinationURL] path];
+
+    @synchronized(self.backgroundTaskRecords) {
+        self.backgroundTaskRecords[[@(operation.task.taskIdentifier) stringValue]] = record;
+    }
+
+    [self writeBackgroundTaskRecords];
+}
+
+- (void)removeRecordForTask:(NSURLSessionTask *)task {
+    [self removeRecordForTaskIdentifier:task.taskIdentifier];
+}
+
+- (void)removeRecordForTaskIdentifier:(NSUInteger)taskIdentifier {
+    NSString *key = [@(taskIdentifier) stringValue];
+
+    @synchronized(self.backgroundTaskRecords) {
+        if (!self.backgroundTaskRecords[key])
+            return;
+        [self.backgroundTaskRecords removeObjectForKey:key];
+    }
+
+    [self writeBackgroundTaskRecords];
+}
+
+/* Register a lightweight operation for each task recorded in a previous launch.
+ *
+ * This just reads a small plist, so it doesn't materially delay the creation of the session.
+ */
+- (void)restoreBackgroundTaskOperations {
+    NSDictionary *records = [NSDictionary dictionaryWithContentsOfURL:[self backgroundTaskRecordsURL]];
+    NSTimeInterval now = [NSDate timeIntervalSinceReferenceDate];
+
+    self.backgroundTaskRecords = [NSMutableDictionary dictionary];
+
+    [records enumerateKeysAndObjectsUsingBlock:^(NSString *key, NSDictionary *record, BOOL *stop) {
+        if (![record isKindOfClass:[NSDictionary class]])
+            return;
+
+        // the system may never report the completion of some tasks (e.g. if the user force quit the app), so discard stale records
+
+        if (now - [record[kBackgroundTaskRecordDateKey] doubleValue] > kBackgroundTaskRecordLifetime)
+            return;
+
+        Class operationClass = NSClassFromString(record[kBackgroundTaskRecordClassKey]);
+        if (![operationClass isSubclassOfClass:[NetworkTaskOperation class]])
+            return;
+
+        NetworkTaskOperation *operation = [[operationClass alloc] init];
+        operation.purpose = record[kBackgroundTaskRecordPurposeKey];
+        operation.handlerKey = record[kBackgroundTaskRecordHandlerKey];
+        operation.completionQueue = self.completionQueue;
+        if (record[kBackgroundTaskRecordDestinationKey] && [operation isKindOfClass:[NetworkDownloadTaskOperation class]])
+            [(NetworkDownloadTaskOperation *)operation setDestinationURL:[NSURL fileURLWithPath:record[kBackgroundTaskRecordDestinationKey]]];
+
+        self.backgroundTaskRecords[key] = record;
+        [self setOperation:operation forTaskIdentifier:(NSUInteger)[key integerValue]];
+        [self.unboundOperations addObject:operation];
+        [self.restoredOperationSet addObject:operation];
+    }];
+}
+
+/* Attach the live tasks to the restored operations, so that they can be canceled, suspended, etc.
+ *
+ * A restored operation whose task the session no longer has (e.g. the system discarded it) will never receive
+ * another event, so it is removed, along with its record, and canceled with an error, so its caller is told.
+ */
+- (void)attachRestoredTasks {
+    if ([self.restoredOperationSet count] == 0)
+        return;
+
+    [self.session getTasksWithCompletionHandler:^(NSArray *dataTasks, NSArray *uploadTasks, NSArray *downloadTasks) {
+        NSMutableSet *liveTaskKeys = [NSMutableSet set];
+
+        for (NSArray *tasks in @[dataTasks, uploadTasks, downloadTasks]) {
+            for (NSURLSessionTask *task in tasks) {
+                [liveTaskKeys addObject:[@(task.taskIdentifier) stringValue]];
+
+                NetworkTaskOperation *operation = [self registeredOperationForTaskIdentifier:task.taskIdentifier];
+                if (operation && !operation.task)
+                    operation.task = task;
+            }
+        }
+
+        NSArray *recordedTaskKeys;
+
+        @synchronized(self.backgroundTaskRecords) {
+            recordedTaskKeys = [self.backgroundTaskRecords allKeys];
+        }
+
+        for (NSString *key in recordedTaskKeys) {
+            if ([liveTaskKeys containsObject:key])
+                continue;
+
+            NSUInteger taskIdentifier = (NSUInteger)[key integerValue];
+            NetworkTaskOperation *operation = [self registeredOperationForTaskIdentifier:taskIdentifier];
+            if (!operation || operation.task)
+                continue;
+
+            @synchronized(self.unboundOperations) {
+                if (![self.restoredOperationSet containsObject:operation])
+                    continue;
+            }
+
+            [self failRestoredOperation:operation taskIdentifier:taskIdentifier];
+        }
+    }];
+}
+
+/* Remove a restored operation whose task didn't survive (and its record), and report it as canceled.
+ *
+ * The error is delivered just as the session would have delivered it, through the operation's own completion (so a
+ * download's `didFinishDownloadingHandler` is told, too) or, if it has no handlers, the manager-level `didCompleteWithError`.
+ */
+- (void)failRestoredOperation:(NetworkTaskOperation *)operation taskIdentifier:(NSUInteger)taskIdentifier {
+    [self removeOperationForTaskIdentifier:taskIdentifier];
+    [self removeRecordForTaskIdentifier:taskIdentifier];
+
+    [self bindHandlersOfRestoredOperation:operation];
+
+    @synchronized(self.unboundOperations) {
+        [self.unboundOperations removeObject:operation];
+        [self.restoredOperationSet removeObject:operation];
+    }
+
+    NSError *error = [NSError errorWithDomain:NSURLErrorDomain code:NSURLErrorCancelled userInfo:@{NSLocalizedDescriptionKey: @"The background task was not restored by the system"}];
+    [operation cancelWithError:error];
+
+    BOOL hasHandler = operation.didCompleteWithDataErrorHandler || ([operation isKindOfClass:[NetworkDownloadTaskOperation class]] && [(NetworkDownloadTaskOperation *)operation didFinishDownloadingHandler]);
+
+    if (hasHandler) {
+        [operation URLSession:self.session task:operation.task didCompleteWithError:error];
+    } else {
+        if (self.didCompleteWithError) {
+            dispatch_sync(self.completionQueue ?: dispatch_get_main_queue(), ^{
+                self.didCompleteWithError(self, operation.task, error);
+            });
+        }
+
+        [operation completeOperation];
+    }
+}
+
+/* The operation for a task, binding its handlers first if it was restored and hasn't been bound yet.
+ */
+- (id)operationForTask:(NSURLSessionTask *)task {
+    NetworkTaskOperation *operation = [self registeredOperationForTaskIdentifier:task.taskIdentifier];
+
+    if (!operation || !self.backgroundIdentifier)
+        return operation;
+
+    if (!operation.task)
+        operation.task = task;
+
+    [self bindHandlersOfRestoredOperation:operation];
+
+    return operation;
+}
+
+/* Bind the handlers of a restored operation, if it hasn't been bound yet and there is a binder for it.
+ */
+- (void)bindHandlersOfRestoredOperation:(NetworkTaskOperation *)operation {
+    TaskOperationHandlerBinder binder;
+
+    @synchronized(self.unboundOperations) {
+        if (![self.unboundOperations containsObject:operation])
+            return;
+
+        binder = operation.handlerKey ? self.handlerBinders[operation.handlerKey] : nil;
+        if (!binder)
+            return;
+
+        [self.unboundOperations removeObject:operation];
+    }
+
+    operation.completionQueue = self.completionQueue;
+    operation.tracer = self.tracer;
+    binder(self, operation);
+}
+
+- (void)registerHandlerBinder:(TaskOperationHandlerBinder)binder forKey:(NSString *)key {
+    NSParameterAssert(key);
+
+    @synchronized(self.unboundOperations) {
+        if (binder)
+            self.handlerBinders[key] = [binder copy];
+        else
+            [self.handlerBinders removeObjectForKey:key];
+    }
+}
+
+- (NSArray *)restoredOperations {
+    @synchronized(self.unboundOperations) {
+        return [self.restoredOperationSet allObjects];
+    }
+}
+
 #pragma mark - NSURLSessionDelegate
 
 - (void)URLSession:(NSURLSession *)session didBecomeInvalidWithError:(NSError *)error {
@@ -256,16 +754,54 @@ static NSMutableDictionary *_backgroundSessions;
     }
 }
 
+/* Answer challenge from the `authenticationCache` if we can, otherwise call `handler` to make the decision (and cache it).
+ *
+ * @param challenge         The authentication challenge.
+ * @param task              The task for which the challenge was received, or `nil` if it is a session-level challenge.
+ * @param completionHandler The session's completion handler for the challenge.
+ * @param handler           The block that makes the decision, calling the completion handler it is passed.
+ */
+- (void)resolveChallenge:(NSURLAuthenticationChallenge *)challenge
+                    task:(NSURLSessionTask *)task
+       completionHandler:(ChallengeCompletionHandler)completionHandler
+            usingHandler:(void (^)(ChallengeCompletionHandler completionHandler))handler {
+    NetworkAuthenticationCache *cache = self.authenticationCache;
+    NetworkTracer *tracer = self.tracer;
+    uint64_t start = tracer ? NetworkTracerNow() : 0;
+
+    NSURLSessionAuthChallengeDisposition disposition;
+    NSURLCredential *credential;
+
+    if ([cache getDisposition:&disposition credential:&credential forChallenge:challenge]) {
+        [tracer recordSpanNamed:"challenge (cached)" category:"auth" start:start end:NetworkTracerNow() task:task bytes:-1];
+        completionHandler(disposition, credential);
+        return;
+    }
+
+    if (!cache && !tracer) {
+        handler(completionHandler);
+        return;
+    }
+
+    handler(^(NSURLSessionAuthChallengeDisposition disposition, NSURLCredential *credential) {
+        [cache storeDisposition:disposition credential:credential forChallenge:challenge];
+        [tracer recordSpanNamed:"challenge" category:"auth" start:start end:NetworkTracerNow() task:task bytes:-1];
+        completionHandler(disposition, credential);
+    });
+}
+
 - (void)URLSession:(NSURLSession *)session didReceiveChallenge:(NSURLAuthenticationChallenge *)challenge completionHandler:(void (^)(NSURLSessionAuthChallengeDisposition disposition, NSURLCredential *credential))completionHandler {
-    if (self.didReceiveChallenge) {
-        self.didReceiveChallenge(self, challenge, completionHandler);
-    } else {
-        if (self.credential && challenge.previousFailureCount == 0) {
-            completionHandler(NSURLSessionAuthChallengeUseCredential, self.credential);
+    [self resolveChallenge:challenge task:nil completionHandler:completionHandler usingHandler:^(ChallengeCompletionHandler completionHandler) {
+        if (self.didReceiveChallenge) {
+            self.didReceiveChallenge(self, challenge, completionHandler);
         } else {
-            completionHandler(NSURLSessionAuthChallengeCancelAuthenticationChallenge, nil);
+            if (self.credential && challenge.previousFailureCount == 0) {
+                completionHandler(NSURLSessionAuthChallengeUseCredential, self.credential);
+            } else {
+                completionHandler(NSURLSessionAuthChallengeCancelAuthenticationChallenge, nil);
+            }
         }
-    }
+    }];
 }
 
 - (void)URLSessionDidFinishEventsForBackgroundURLSession:(NSURLSession *)session; {
@@ -298,21 +834,41 @@ static NSMutableDictionary *_backgroundSessions;
 #pragma mark - NSURLSessionTaskDelegate
 
 - (void)removeTaskOperationForTask:(NSURLSessionTask *)task {
-    NetworkTaskOperation *taskOperation = self.operations[@(task.taskIdentifier)];
+    // a hedged operation is registered under more than one task identifier, so only remove this task's entry
 
-    if (!taskOperation)
-        return;
-    
-    [self.operations enumerateKeysAndObjectsUsingBlock:^(id key, id obj, BOOL *stop) {
-        if (obj == taskOperation) {
-            [self.operations removeObjectForKey:key];
-            *stop = YES;
+    NetworkTaskOperation *operation = [self removeOperationForTaskIdentifier:task.taskIdentifier];
+
+    if (self.backgroundIdentifier) {
+        [self removeRecordForTask:task];
+
+        @synchronized(self.unboundOperations) {
+            [self.unboundOperations removeObject:operation];
+            [self.restoredOperationSet removeObject:operation];
         }
-    }];
+    }
 }
 
 - (void)URLSession:(NSURLSession *)session task:(NSURLSessionTask *)task didCompleteWithError:(NSError *)error {
-    NetworkTaskOperation *operation = self.operations[@(task.taskIdentifier)];
+    NetworkTaskOperation *operation = [self operationForTask:task];
+
+    // every task is reported to the circuit breaker, even a hedge that lost, since it may have been admitted as a probe
+
+    [self.circuitBreaker recordCompletionOfTask:task error:error];
+
+    // if this was a hedge that lost the race (or failed while its twin is still running), there's nothing to report
+
+    if ([operation isKindOfClass:[NetworkDataTaskOperation class]] && ![(NetworkDataTaskOperation *)operation completionOfTaskFinishesOperation:task]) {
+        [self removeTaskOperationForTask:task];
+        return;
+    }
+
+    if (operation.cancellationError)
+        error = operation.cancellationError;
+
+    // a download that couldn't be moved to its `destinationURL` failed, even though the task succeeded
+
+    if (!error && [operation isKindOfClass:[NetworkDownloadTaskOperation class]])
+        error = [(NetworkDownloadTaskOperation *)operation moveError];
 
     if ([operation respondsToSelector:@selector(URLSession:task:didCompleteWithError:)] && operation.didCompleteWithDataErrorHandler) {
         [operation URLSession:session task:task didCompleteWithError:error];
@@ -330,36 +886,39 @@ static NSMutableDictionary *_backgroundSessions;
 }
 
 - (void)URLSession:(NSURLSession *)session task:(NSURLSessionTask *)task didReceiveChallenge:(NSURLAuthenticationChallenge *)challenge completionHandler:(void (^)(NSURLSessionAuthChallengeDisposition disposition, NSURLCredential *credential))completionHandler {
-    NetworkTaskOperation *operation = self.operations[@(task.taskIdentifier)];
+    NetworkTaskOperation *operation = [self operationForTask:task];
 
-    // if the operation can handle challenge, then give it one shot, otherwise, we'll take over here
+    [self resolveChallenge:challenge task:task completionHandler:completionHandler usingHandler:^(ChallengeCompletionHandler completionHandler) {
 
-    if ([operation respondsToSelector:@selector(URLSession:task:didReceiveChallenge:completionHandler:)] && challenge.previousFailureCount == 0 && [operation canRespondToChallenge]) {
-        [operation URLSession:session task:task didReceiveChallenge:challenge completionHandler:completionHandler];
-    } else {
-        if (self.didReceiveChallenge) {
-            dispatch_sync(self.completionQueue ?: dispatch_get_main_queue(), ^{
-                self.didReceiveChallenge(self, challenge, completionHandler);
-            });
+        // if the operation can handle challenge, then give it one shot, otherwise, we'll take over here
+
+        if ([operation respondsToSelector:@selector(URLSession:task:didReceiveChallenge:completionHandler:)] && challenge.previousFailureCount == 0 && [operation canRespondToChallenge]) {
+            [operation URLSession:session task:task didReceiveChallenge:challenge completionHandler:completionHandler];
         } else {
-            if (self.credential && challenge.previousFailureCount == 0) {
-                completionHandler(NSURLSessionAuthChallengeUseCredential, self.credential);
+            if (self.didReceiveChallenge) {
+                dispatch_sync(self.completionQueue ?: dispatch_get_main_queue(), ^{
+                    self.didReceiveChallenge(self, challenge, completionHandler);
+                });
             } else {
-                completionHandler(NSURLSessionAuthChallengeCancelAuthenticationChallenge, nil);
+                if (self.credential && challenge.previousFailureCount == 0) {
+                    completionHandler(NSURLSessionAuthChallengeUseCredential, self.credential);
+                } else {
+                    completionHandler(NSURLSessionAuthChallengeCancelAuthenticationChallenge, nil);
+                }
             }
         }
-    }
+    }];
 }
 
 - (void)URLSession:(NSURLSession *)session task:(NSURLSessionTask *)task didSendBodyData:(int64_t)bytesSent totalBytesSent:(int64_t)totalBytesSent totalBytesExpectedToSend:(int64_t)totalBytesExpectedToSend {
-    NetworkTaskOperation *operation = self.operations[@(task.taskIdentifier)];
+    NetworkTaskOperation *operation = [self operationForTask:task];
 
     if ([operation respondsToSelector:@selector(URLSession:task:didSendBodyData:totalBytesSent:totalBytesExpectedToSend:)])
         [operation URLSession:session task:task didSendBodyData:bytesSent totalBytesSent:totalBytesSent totalBytesExpectedToSend:totalBytesExpectedToSend];
 }
 
 - (void)URLSession:(NSURLSession *)session task:(NSURLSessionTask *)task needNewBodyStream:(void (^)(NSInputStream *bodyStream))completionHandler {
-    NetworkTaskOperation *operation = self.operations[@(task.taskIdentifier)];
+    NetworkTaskOperation *operation = [self operationForTask:task];
 
     if ([operation respondsToSelector:@selector(URLSession:task:needNewBodyStream:)]) {
         [operation URLSession:session task:task needNewBodyStream:completionHandler];
@@ -369,7 +928,7 @@ static NSMutableDictionary *_backgroundSessions;
 }
 
 - (void)URLSession:(NSURLSession *)session task:(NSURLSessionTask *)task willPerformHTTPRedirection:(NSHTTPURLResponse *)response newRequest:(NSURLRequest *)request completionHandler:(void (^)(NSURLRequest *))completionHandler {
-    NetworkTaskOperation *operation = self.operations[@(task.taskIdentifier)];
+    NetworkTaskOperation *operation = [self operationForTask:task];
 
     if ([operation respondsToSelector:@selector(URLSession:task:willPerformHTTPRedirection:newRequest:completionHandler:)]) {
         [operation URLSession:session task:task willPerformHTTPRedirection:response newRequest:request completionHandler:completionHandler];
@@ -381,24 +940,27 @@ static NSMutableDictionary *_backgroundSessions;
 #pragma mark - NSURLSessionDataDelegate
 
 - (void)URLSession:(NSURLSession *)session dataTask:(NSURLSessionDataTask *)dataTask didReceiveResponse:(NSURLResponse *)response completionHandler:(void (^)(NSURLSessionResponseDisposition disposition))completionHandler {
-    NetworkDataTaskOperation *operation = self.operations[@(dataTask.taskIdentifier)];
+    NetworkDataTaskOperation *operation = [self operationForTask:dataTask];
 
     if ([operation respondsToSelector:@selector(URLSession:dataTask:didReceiveResponse:completionHandler:)]) {
         [operation URLSession:session dataTask:dataTask didReceiveResponse:response completionHandler:completionHandler];
+
+        if (operation.task == dataTask && operation.responseLatency > 0)
+            [self recordResponseLatency:operation.responseLatency forHost:dataTask.originalRequest.URL.host];
     } else {
         completionHandler(NSURLSessionResponseAllow);
     }
 }
 
 - (void)URLSession:(NSURLSession *)session dataTask:(NSURLSessionDataTask *)dataTask didReceiveData:(NSData *)data {
-    NetworkDataTaskOperation *operation = self.operations[@(dataTask.taskIdentifier)];
+    NetworkDataTaskOperation *operation = [self operationForTask:dataTask];
 
     if ([operation respondsToSelector:@selector(URLSession:dataTask:didReceiveData:)])
         [operation URLSession:session dataTask:dataTask didReceiveData:data];
 }
 
 - (void)URLSession:(NSURLSession *)session dataTask:(NSURLSessionDataTask *)dataTask willCacheResponse:(NSCachedURLResponse *)proposedResponse completionHandler:(void (^)(NSCachedURLResponse *cachedResponse))completionHandler {
-    NetworkDataTaskOperation *operation = self.operations[@(dataTask.taskIdentifier)];
+    NetworkDataTaskOperation *operation = [self operationForTask:dataTask];
 
     if ([operation respondsToSelector:@selector(URLSession:dataTask:willCacheResponse:completionHandler:)]) {
         [operation URLSession:session dataTask:dataTask willCacheResponse:proposedResponse completionHandler:completionHandler];
@@ -408,7 +970,7 @@ static NSMutableDictionary *_backgroundSessions;
 }
 
 - (void)URLSession:(NSURLSession *)session dataTask:(NSURLSessionDataTask *)dataTask didBecomeDownloadTask:(NSURLSessionDownloadTask *)downloadTask {
-    NetworkDataTaskOperation *operation = self.operations[@(dataTask.taskIdentifier)];
+    NetworkDataTaskOperation *operation = [self operationForTask:dataTask];
 
     if ([operation respondsToSelector:@selector(URLSession:dataTask:didBecomeDownloadTask:)])
         [operation URLSession:session dataTask:dataTask didBecomeDownloadTask:downloadTask];
@@ -417,27 +979,34 @@ static NSMutableDictionary *_backgroundSessions;
 #pragma mark - NSURLSessionDownloadDelegate
 
 - (void)URLSession:(NSURLSession *)session downloadTask:(NSURLSessionDownloadTask *)downloadTask didWriteData:(int64_t)bytesWritten totalBytesWritten:(int64_t)totalBytesWritten totalBytesExpectedToWrite:(int64_t)totalBytesExpectedToWrite {
-    NetworkDownloadTaskOperation *operation = self.operations[@(downloadTask.taskIdentifier)];
+    NetworkDownloadTaskOperation *operation = [self operationForTask:downloadTask];
 
     if ([operation respondsToSelector:@selector(URLSession:downloadTask:didWriteData:totalBytesWritten:totalBytesExpectedToWrite:)])
         [operation URLSession:session downloadTask:downloadTask didWriteData:bytesWritten totalBytesWritten:totalBytesWritten totalBytesExpectedToWrite:totalBytesExpectedToWrite];
 }
 
 - (void)URLSession:(NSURLSession *)session downloadTask:(NSURLSessionDownloadTask *)downloadTask didResumeAtOffset:(int64_t)fileOffset expectedTotalBytes:(int64_t)expectedTotalBytes {
-    NetworkDownloadTaskOperation *operation = self.operations[@(downloadTask.taskIdentifier)];
+    NetworkDownloadTaskOperation *operation = [self operationForTask:downloadTask];
 
     if ([operation respondsToSelector:@selector(URLSession:downloadTask:didResumeAtOffset:expectedTotalBytes:)])
         [operation URLSession:session downloadTask:downloadTask didResumeAtOffset:fileOffset expectedTotalBytes:expectedTotalBytes];
 }
 
 - (void)URLSession:(NSURLSession *)session downloadTask:(NSURLSessionDownloadTask *)downloadTask didFinishDownloadingToURL:(NSURL *)location {
-    NetworkDownloadTaskOperation *operation = self.operations[@(downloadTask.taskIdentifier)];
+    NetworkDownloadTaskOperation *operation = [self operationForTask:downloadTask];
+    BOOL hasHandler = operation.didFinishDownloadingHandler != nil;
 
-    if ([operation respondsToSelector:@selector(URLSession:downloadTask:didFinishDownloadingToURL:)] && operation.didFinishDownloadingHandler) {
+    if ([operation respondsToSelector:@selector(URLSession:downloadTask:didFinishDownloadingToURL:)] && (hasHandler || operation.destinationURL))
         [operation URLSession:session downloadTask:downloadTask didFinishDownloadingToURL:location];
-    } else if (self.didFinishDownloadingToURL) {
+
+    // without a handler of its own (e.g. a restored operation that hasn't been bound), the manager-level handler is
+    // told where the file is: at the operation's `destinationURL` or, if it couldn't be moved there, where the session left it
+
+    if (!hasHandler && self.didFinishDownloadingToURL) {
+        NSURL *fileURL = (operation.destinationURL && !operation.moveError) ? operation.destinationURL : location;
+
         dispatch_sync(self.completionQueue ?: dispatch_get_main_queue(), ^{
-            self.didFinishDownloadingToURL(self, downloadTask, location);
+            self.didFinishDownloadingToURL(self, downloadTask, fileURL);
         });
     }
 }
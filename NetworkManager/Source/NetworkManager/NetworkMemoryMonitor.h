@@ -0,0 +1,179 @@
+//
+//  NetworkMemoryMonitor.h
+//
+//  Created by agent on 10/19/26.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+//  This work is licensed under a Creative Commons Attribution-ShareAlike 4.0 International License.
+//  http://creativecommons.org/licenses/by-sa/4.0/
+
+#import <Foundation/Foundation.h>
+
+@class NetworkTaskOperation;
+
+extern NSString * const kNetworkMemoryMonitorErrorDomain;
+
+typedef NS_ENUM(NSInteger, NetworkMemoryMonitorErrorCode) {
+    NetworkMemoryMonitorErrorCodeRejected = 1
+};
+
+typedef NS_ENUM(NSInteger, NetworkMemoryShedding) {
+    NetworkMemorySheddingNone,
+    NetworkMemorySheddingSpillResponses,
+    NetworkMemorySheddingPauseBulk,
+    NetworkMemorySheddingRejectBulk
+};
+
+typedef NS_ENUM(NSInteger, NetworkMemoryCategory) {
+    NetworkMemoryCategoryResponseBuffer,
+    NetworkMemoryCategoryQueuedBody
+};
+
+/** Accounts for the memory held by a manager's operations, and sheds load when there is too much.
+
+ When assigned to the `memoryMonitor` property of a `<NetworkManager>`, the operations it subsequently creates report
+ the bytes held by their response buffers (i.e. the `NSData` a `NetworkDataTaskOperation` builds for its completion handler),
+ and `addOperation:` reports the bodies of queued upload and data operations. The bytes are released when the operation completes.
+
+ When the total exceeds `<highWatermark>`, or the system reports memory pressure, the monitor sheds load in steps:
+
+ 1. _Spill responses_: any in-progress response buffer larger than `<spillThreshold>` is moved to a temporary file,
+    to which the rest of the response is written. The completion handler receives the response memory-mapped from that file.
+    On entering this step (or escalating past it), every buffer already over the threshold is spilled right away, before
+    any task is suspended; buffers that cross the threshold later are spilled as their data arrives.
+ 2. _Pause bulk_: the tasks of running operations whose `bulk` property is `YES` are suspended.
+ 3. _Reject bulk_: new `bulk` operations passed to `addOperation:` are canceled with a `kNetworkMemoryMonitorErrorDomain` error
+    rather than being queued.
+
+ While usage stays above the watermark, the monitor escalates a step at most once every `<escalationInterval>` seconds.
+ A system warning goes straight to pausing bulk tasks, and a critical warning to rejecting them. Once usage falls
+ below `<lowWatermark>` and the system is no longer under pressure, paused tasks are resumed and shedding stops.
+
+ The system's memory pressure is observed with a `DISPATCH_SOURCE_TYPE_MEMORYPRESSURE` source, which is only available
+ as of iOS 8. On earlier versions, each `UIApplicationDidReceiveMemoryWarningNotification` is treated as a warning
+ (pausing bulk tasks) that is taken to have passed ten seconds after the last one, since the system doesn't say.
+
+ The properties in "Metrics" can be used for monitoring.
+ */
+
+@interface NetworkMemoryMonitor : NSObject
+
+/// ----------------
+/// @name Properties
+/// ----------------
+
+/// The number of bytes above which the monitor starts to shed load. Default is 64 MB.
+
+@property (nonatomic) int64_t highWatermark;
+
+/// The number of bytes below which the monitor stops shedding load. Default is 48 MB.
+
+@property (nonatomic) int64_t lowWatermark;
+
+/// The size, in bytes, above which an in-progress response buffer is spilled to disk when shedding. Default is 512 KB.
+
+@property (nonatomic) NSUInteger spillThreshold;
+
+/// The minimum number of seconds between escalations while usage stays above `<highWatermark>`. Default is 1 second.
+
+@property (nonatomic) NSTimeInterval escalationInterval;
+
+/// -------------
+/// @name Metrics
+/// -------------
+
+/// The current shedding step.
+
+@property (readonly) NetworkMemoryShedding shedding;
+
+/// Whether the system has reported memory pressure (and not yet reported that it has subsided).
+
+@property (readonly, getter = isUnderSystemMemoryPressure) BOOL underSystemMemoryPressure;
+
+/// The number of bytes currently held by response buffers and queued bodies.
+
+@property (readonly) int64_t currentBytes;
+
+/// The number of bytes currently held by response buffers.
+
+@property (readonly) int64_t responseBufferBytes;
+
+/// The number of bytes currently held by the bodies of queued and running operations.
+
+@property (readonly) int64_t queuedBodyBytes;
+
+/// The highest `currentBytes` observed.
+
+@property (readonly) int64_t peakBytes;
+
+/// The number of bytes of response buffers that have been spilled to disk.
+
+@property (readonly) int64_t spilledBytes;
+
+/// The number of responses that have been spilled to disk.
+
+@property (readonly) NSUInteger spillCount;
+
+/// The number of bulk operations whose tasks are currently suspended.
+
+@property (readonly) NSUInteger pausedOperationCount;
+
+/// The number of bulk operations that have been rejected.
+
+@property (readonly) NSUInteger rejectedOperationCount;
+
+/// ------------------
+/// @name Accounting
+/// ------------------
+
+/** Determine whether an operation may be queued.
+ *
+ * @param operation The operation to be queued.
+ * @param error     If the operation may not be queued, this will be set to the error with which it should fail.
+ *
+ * @return `YES` if the operation may be queued. `NO` if it is a bulk operation and bulk operations are being rejected.
+ */
+
+- (BOOL)shouldAcceptOperation:(NetworkTaskOperation *)operation error:(NSError **)error;
+
+/** Record that an operation has started. If it is a bulk operation and bulk operations are paused, its task is suspended.
+ *
+ * @param operation The operation.
+ */
+
+- (void)operationDidStart:(NetworkTaskOperation *)operation;
+
+/** Record bytes held by an operation.
+ *
+ * @param operation The operation.
+ * @param bytes     The number of bytes the operation now additionally holds (or, if negative, has released).
+ * @param category  What holds the bytes.
+ */
+
+- (void)operation:(NetworkTaskOperation *)operation didAddBytes:(int64_t)bytes category:(NetworkMemoryCategory)category;
+
+/** Determine whether a response buffer should be spilled to disk.
+ *
+ * @param length The length of the response buffer.
+ *
+ * @return `YES` if the monitor is shedding and the buffer is larger than `<spillThreshold>`.
+ */
+
+- (BOOL)shouldSpillResponseOfLength:(NSUInteger)length;
+
+/** Record that an operation has spilled its response buffer to disk. This releases the buffer's bytes.
+ *
+ * @param operation The operation.
+ * @param bytes     The number of bytes spilled.
+ */
+
+- (void)operation:(NetworkTaskOperation *)operation didSpillBytes:(int64_t)bytes;
+
+/** Record that an operation has finished, releasing all of the bytes it holds.
+ *
+ * @param operation The operation.
+ */
+
+- (void)operationDidFinish:(NetworkTaskOperation *)operation;
+
+@end
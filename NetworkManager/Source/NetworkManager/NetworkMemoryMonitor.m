@@ -0,0 +1,355 @@
+//
+//  NetworkMemoryMonitor.m
+//
+//  Created by agent on 10/19/26.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+//  This work is licensed under a Creative Commons Attribution-ShareAlike 4.0 International License.
+//  http://creativecommons.org/licenses/by-sa/4.0/
+
+#import "NetworkMemoryMonitor.h"
+#import "NetworkTaskOperation.h"
+#import "NetworkDataTaskOperation.h"
+#import <UIKit/UIKit.h>
+
+NSString * const kNetworkMemoryMonitorErrorDomain = @"NetworkMemoryMonitor";
+
+/* Before iOS 8, the system reports a memory warning, but not when it has passed, so it is taken to last this long.
+ */
+static NSTimeInterval const kMemoryWarningDuration = 10.0;
+
+/** The bytes held by a single operation.
+ */
+@interface NetworkMemoryAccount : NSObject
+@property (nonatomic) int64_t responseBufferBytes;
+@property (nonatomic) int64_t queuedBodyBytes;
+@end
+
+@implementation NetworkMemoryAccount
+@end
+
+
+@interface NetworkMemoryMonitor ()
+
+@property (nonatomic, strong) NSMapTable *accounts;
+@property (nonatomic, strong) NSHashTable *bulkOperations;
+@property (nonatomic, strong) NSHashTable *pausedOperations;
+@property (nonatomic, strong) dispatch_source_t memoryPressureSource;
+@property (nonatomic, strong) id memoryWarningObserver;
+@property (nonatomic) NSUInteger memoryWarningCount;
+@property (nonatomic) CFAbsoluteTime escalationTime;
+@property (nonatomic) NetworkMemoryShedding systemShedding;
+
+@property (readwrite) NetworkMemoryShedding shedding;
+@property (readwrite, getter = isUnderSystemMemoryPressure) BOOL underSystemMemoryPressure;
+@property (readwrite) int64_t responseBufferBytes;
+@property (readwrite) int64_t queuedBodyBytes;
+@property (readwrite) int64_t peakBytes;
+@property (readwrite) int64_t spilledBytes;
+@property (readwrite) NSUInteger spillCount;
+@property (readwrite) NSUInteger rejectedOperationCount;
+
+@end
+
+@implementation NetworkMemoryMonitor
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        _accounts = [NSMapTable mapTableWithKeyOptions:NSPointerFunctionsStrongMemory | NSPointerFunctionsObjectPointerPersonality
+                                          valueOptions:NSPointerFunctionsStrongMemory];
+        _bulkOperations = [NSHashTable weakObjectsHashTable];
+        _pausedOperations = [NSHashTable hashTableWithOptions:NSPointerFunctionsStrongMemory | NSPointerFunctionsObjectPointerPersonality];
+        _highWatermark = 64 * 1024 * 1024;
+        _lowWatermark = 48 * 1024 * 1024;
+        _spillThreshold = 512 * 1024;
+        _escalationInterval = 1.0;
+
+        [self startObservingMemoryPressure];
+    }
+    return self;
+}
+
+- (void)dealloc {
+    if (_memoryPressureSource)
+        dispatch_source_cancel(_memoryPressureSource);
+    if (_memoryWarningObserver)
+        [[NSNotificationCenter defaultCenter] removeObserver:_memoryWarningObserver];
+}
+
+- (void)startObservingMemoryPressure {
+    // the memory pressure dispatch source is only available as of iOS 8 (and weakly linked before that)
+
+#if __IPHONE_OS_VERSION_MAX_ALLOWED >= 80000
+    if (DISPATCH_SOURCE_TYPE_MEMORYPRESSURE != NULL) {
+        [self startObservingMemoryPressureSource];
+        return;
+    }
+#endif
+
+    [self startObservingMemoryWarnings];
+}
+
+#if __IPHONE_OS_VERSION_MAX_ALLOWED >= 80000
+
+- (void)startObservingMemoryPressureSource {
+    dispatch_source_t source = dispatch_source_create(DISPATCH_SOURCE_TYPE_MEMORYPRESSURE, 0,
+                                                      DISPATCH_MEMORYPRESSURE_NORMAL | DISPATCH_MEMORYPRESSURE_WARN | DISPATCH_MEMORYPRESSURE_CRITICAL,
+                                                      dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_HIGH, 0));
+    if (!source)
+        return;
+
+    __weak NetworkMemoryMonitor *weakSelf = self;
+    dispatch_source_set_event_handler(source, ^{
+        unsigned long pressure = dispatch_source_get_data(source);
+        NetworkMemoryShedding shedding = NetworkMemorySheddingNone;
+
+        if (pressure & DISPATCH_MEMORYPRESSURE_CRITICAL)
+            shedding = NetworkMemorySheddingRejectBulk;
+        else if (pressure & DISPATCH_MEMORYPRESSURE_WARN)
+            shedding = NetworkMemorySheddingPauseBulk;
+
+        [weakSelf systemMemoryPressureDidChange:shedding];
+    });
+    dispatch_resume(source);
+
+    self.memoryPressureSource = source;
+}
+
+#endif
+
+/* Treat each memory warning as a system warning, i.e. pause bulk tasks, lasting `kMemoryWarningDuration` seconds
+ * after the last one.
+ */
+- (void)startObservingMemoryWarnings {
+    __weak NetworkMemoryMonitor *weakSelf = self;
+
+    self.memoryWarningObserver = [[NSNotificationCenter defaultCenter] addObserverForName:UIApplicationDidReceiveMemoryWarningNotification object:nil queue:nil usingBlock:^(NSNotification *note) {
+        NetworkMemoryMonitor *strongSelf = weakSelf;
+        NSUInteger warningCount;
+
+        if (!strongSelf)
+            return;
+
+        @synchronized(strongSelf) {
+            warningCount = ++strongSelf.memoryWarningCount;
+        }
+
+        [strongSelf systemMemoryPressureDidChange:NetworkMemorySheddingPauseBulk];
+
+        dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(kMemoryWarningDuration * NSEC_PER_SEC)), dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_HIGH, 0), ^{
+            NetworkMemoryMonitor *strongSelf = weakSelf;
+            BOOL latest;
+
+            @synchronized(strongSelf) {
+                latest = strongSelf.memoryWarningCount == warningCount;
+            }
+
+            if (latest)
+                [strongSelf systemMemoryPressureDidChange:NetworkMemorySheddingNone];
+        });
+    }];
+}
+
+- (void)systemMemoryPressureDidChange:(NetworkMemoryShedding)shedding {
+    NSArray *spill, *suspend, *resume;
+
+    @synchronized(self) {
+        self.systemShedding = shedding;
+        self.underSystemMemoryPressure = shedding != NetworkMemorySheddingNone;
+        [self evaluateSpilling:&spill suspending:&suspend resuming:&resume];
+    }
+
+    [self spillOperations:spill suspendOperations:suspend resumeOperations:resume];
+}
+
+#pragma mark - Metrics
+
+- (int64_t)currentBytes {
+    @synchronized(self) {
+        return self.responseBufferBytes + self.queuedBodyBytes;
+    }
+}
+
+- (NSUInteger)pausedOperationCount {
+    @synchronized(self) {
+        return [self.pausedOperations count];
+    }
+}
+
+#pragma mark - Shedding
+
+/* Determine the shedding step for the current usage, which response buffers must consequently be spilled,
+ * and which bulk operations suspended or resumed.
+ *
+ * This must be called while synchronized on `self`. The buffers are spilled, and the tasks suspended and resumed,
+ * by the caller, once it is not.
+ */
+- (void)evaluateSpilling:(NSArray **)spill suspending:(NSArray **)suspend resuming:(NSArray **)resume {
+    int64_t currentBytes = self.responseBufferBytes + self.queuedBodyBytes;
+    NetworkMemoryShedding previousShedding = self.shedding;
+    NetworkMemoryShedding shedding = previousShedding;
+    CFAbsoluteTime now = CFAbsoluteTimeGetCurrent();
+
+    self.peakBytes = MAX(self.peakBytes, currentBytes);
+
+    if (currentBytes > self.highWatermark) {
+        // escalate one step at a time, to give the previous step a chance to work
+
+        if (shedding == NetworkMemorySheddingNone || (shedding < NetworkMemorySheddingRejectBulk && now - self.escalationTime >= self.escalationInterval)) {
+            shedding++;
+            self.escalationTime = now;
+        }
+    } else if (currentBytes < self.lowWatermark) {
+        shedding = NetworkMemorySheddingNone;
+    }
+
+    shedding = MAX(shedding, self.systemShedding);
+    self.shedding = shedding;
+
+    *spill = nil;
+    *suspend = nil;
+    *resume = nil;
+
+    // on escalating, spill every buffer over the threshold right away, rather than waiting for more of its response
+    // to arrive (which, for a task that is about to be suspended, it won't)
+
+    if (shedding >= NetworkMemorySheddingSpillResponses && shedding > previousShedding) {
+        NSMutableArray *operations = [NSMutableArray array];
+        for (NetworkTaskOperation *operation in self.accounts) {
+            if ([operation isKindOfClass:[NetworkDataTaskOperation class]] && [[self.accounts objectForKey:operation] responseBufferBytes] > (int64_t)self.spillThreshold)
+                [operations addObject:operation];
+        }
+        *spill = operations;
+    }
+
+    if (shedding >= NetworkMemorySheddingPauseBulk) {
+        NSMutableArray *operations = [NSMutableArray array];
+        for (NetworkTaskOperation *operation in self.bulkOperations) {
+            if (![self.pausedOperations containsObject:operation]) {
+                [self.pausedOperations addObject:operation];
+                [operations addObject:operation];
+            }
+        }
+        *suspend = operations;
+    } else if ([self.pausedOperations count] > 0) {
+        *resume = [self.pausedOperations allObjects];
+        [self.pausedOperations removeAllObjects];
+    }
+}
+
+- (void)spillOperations:(NSArray *)spill suspendOperations:(NSArray *)suspend resumeOperations:(NSArray *)resume {
+    for (NetworkDataTaskOperation *operation in spill) {
+        [operation spillResponseData];
+    }
+    for (NetworkTaskOperation *operation in suspend) {
+        [operation.task suspend];
+    }
+    for (NetworkTaskOperation *operation in resume) {
+        [operation.task resume];
+    }
+}
+
+#pragma mark - Accounting
+
+- (NetworkMemoryAccount *)accountForOperation:(NetworkTaskOperation *)operation {
+    NetworkMemoryAccount *account = [self.accounts objectForKey:operation];
+    if (!account) {
+        account = [[NetworkMemoryAccount alloc] init];
+        [self.accounts setObject:account forKey:operation];
+    }
+    return account;
+}
+
+- (BOOL)shouldAcceptOperation:(NetworkTaskOperation *)operation error:(NSError **)error {
+    @synchronized(self) {
+        if (![operation isBulk] || self.shedding < NetworkMemorySheddingRejectBulk)
+            return YES;
+
+        self.rejectedOperationCount++;
+    }
+
+    if (error) {
+        NSURL *url = operation.task.originalRequest.URL;
+        NSMutableDictionary *userInfo = [NSMutableDictionary dictionaryWithObject:@"Bulk request rejected because memory is low" forKey:NSLocalizedDescriptionKey];
+        if (url)
+            userInfo[NSURLErrorKey] = url;
+
+        *error = [NSError errorWithDomain:kNetworkMemoryMonitorErrorDomain code:NetworkMemoryMonitorErrorCodeRejected userInfo:userInfo];
+    }
+
+    return NO;
+}
+
+- (void)operationDidStart:(NetworkTaskOperation *)operation {
+    if (![operation isBulk])
+        return;
+
+    BOOL pause = NO;
+
+    @synchronized(self) {
+        [self.bulkOperations addObject:operation];
+        if (self.shedding >= NetworkMemorySheddingPauseBulk) {
+            [self.pausedOperations addObject:operation];
+            pause = YES;
+        }
+    }
+
+    if (pause)
+        [operation.task suspend];
+}
+
+- (void)operation:(NetworkTaskOperation *)operation didAddBytes:(int64_t)bytes category:(NetworkMemoryCategory)category {
+    NSArray *spill, *suspend, *resume;
+
+    @synchronized(self) {
+        NetworkMemoryAccount *account = [self accountForOperation:operation];
+
+        if (category == NetworkMemoryCategoryResponseBuffer) {
+            account.responseBufferBytes += bytes;
+            self.responseBufferBytes += bytes;
+        } else {
+            account.queuedBodyBytes += bytes;
+            self.queuedBodyBytes += bytes;
+        }
+
+        [self evaluateSpilling:&spill suspending:&suspend resuming:&resume];
+    }
+
+    [self spillOperations:spill suspendOperations:suspend resumeOperations:resume];
+}
+
+- (BOOL)shouldSpillResponseOfLength:(NSUInteger)length {
+    return self.shedding >= NetworkMemorySheddingSpillResponses && length > self.spillThreshold;
+}
+
+- (void)operation:(NetworkTaskOperation *)operation didSpillBytes:(int64_t)bytes {
+    @synchronized(self) {
+        self.spilledBytes += bytes;
+        self.spillCount++;
+    }
+
+    [self operation:operation didAddBytes:-bytes category:NetworkMemoryCategoryResponseBuffer];
+}
+
+- (void)operationDidFinish:(NetworkTaskOperation *)operation {
+    NSArray *spill, *suspend, *resume;
+
+    @synchronized(self) {
+        NetworkMemoryAccount *account = [self.accounts objectForKey:operation];
+        if (account) {
+            self.responseBufferBytes -= account.responseBufferBytes;
+            self.queuedBodyBytes -= account.queuedBodyBytes;
+            [self.accounts removeObjectForKey:operation];
+        }
+
+        [self.bulkOperations removeObject:operation];
+        [self.pausedOperations removeObject:operation];
+
+        [self evaluateSpilling:&spill suspending:&suspend resuming:&resume];
+    }
+
+    [self spillOperations:spill suspendOperations:suspend resumeOperations:resume];
+}
+
+@end
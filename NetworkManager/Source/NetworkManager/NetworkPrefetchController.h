@@ -0,0 +1,187 @@
+//
+//  NetworkPrefetchController.h
+//
+//  Created by agent on 10/19/26.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+//  This work is licensed under a Creative Commons Attribution-ShareAlike 4.0 International License.
+//  http://creativecommons.org/licenses/by-sa/4.0/
+
+#import <Foundation/Foundation.h>
+#import "NetworkDownloadTaskOperation.h"
+
+@class NetworkManager;
+@class NetworkPrefetchController;
+
+typedef NS_ENUM(NSInteger, NetworkPrefetchVisibility) {
+    NetworkPrefetchVisibilityFar,
+    NetworkPrefetchVisibilityNear,
+    NetworkPrefetchVisibilityVisible
+};
+
+typedef NetworkTaskOperation *(^NetworkPrefetchOperationProvider)(NetworkPrefetchController *controller,
+                                                                  NSURL *url,
+                                                                  NSData *resumeData);
+
+/** Starts, prioritizes and cancels downloads as the items of a list scroll in and out of view.
+
+ Rather than queuing a download for every row of a table up front, tell the controller which URLs are visible
+ (generally with `<updateVisibleRange:>` from `scrollViewDidScroll:`), and it:
+
+ - starts (or promotes) the downloads of _visible_ URLs at high priority;
+ - speculatively starts the downloads of _near_ URLs (those within `<nearDistance>` of the visible range) at low priority;
+ - cancels the downloads of _far_ URLs, keeping their resume data (if any) so that they pick up where they
+   left off should they come back into view.
+
+ A URL whose download is still in progress when it becomes visible again reuses that operation, and a URL
+ whose download has finished is not downloaded again (unless it failed or is passed to `<forgetURLs:>`). Finished
+ operations are released; only the URLs of the most recent `<finishedURLLimit>` successful downloads are remembered.
+
+ The operations are marked `bulk`, so a manager's `memoryMonitor` pauses (or rejects) them under memory pressure.
+
+ This does not depend upon UIKit, so it can be driven headless, e.g. by replaying a scroll trace of visible ranges
+ and supplying an `<operationProvider>` that returns stand-in operations, then checking the counters in "Metrics".
+
+ All of the methods should be called from the same queue (generally the main queue).
+ */
+
+@interface NetworkPrefetchController : NSObject
+
+/// ----------------
+/// @name Properties
+/// ----------------
+
+/// The manager to which operations are added.
+
+@property (nonatomic, weak, readonly) NetworkManager *manager;
+
+/// The URLs of the items of the list, in order. Ranges passed to `<updateVisibleRange:>` are indexes into this array.
+
+@property (nonatomic, copy) NSArray *urls;
+
+/// The number of items on either side of the visible range that are considered near. Default is 10.
+
+@property (nonatomic) NSUInteger nearDistance;
+
+/// The maximum number of far downloads for which resume data is kept. Default is 50.
+
+@property (nonatomic) NSUInteger resumeDataLimit;
+
+/// The maximum number of finished downloads whose URLs are remembered, so that they aren't downloaded again. Default is 1000.
+
+@property (nonatomic) NSUInteger finishedURLLimit;
+
+/** Called as data is written by the downloads this controller creates.
+ *
+ * This is only used by the default `<operationProvider>`.
+ */
+@property (nonatomic, copy) DidWriteDataHandler didWriteDataHandler;
+
+/** Called when a download this controller creates finishes.
+ *
+ * This is only used by the default `<operationProvider>`. It is not called for downloads that the controller
+ * itself canceled because their URLs became far.
+ */
+@property (nonatomic, copy) DidFinishDownloadingHandler didFinishDownloadingHandler;
+
+/** Creates the operation for a URL. The controller adds it to the `manager` (with `addOperation:`) and sets its priority.
+ *
+ * This uses the following typedef:
+ *
+ *     typedef NetworkTaskOperation *(^NetworkPrefetchOperationProvider)(NetworkPrefetchController *controller,
+ *                                                                       NSURL *url,
+ *                                                                       NSData *resumeData);
+ *
+ * `resumeData` is the data saved when the URL's previous download was canceled, or `nil` if there is none.
+ *
+ * The default creates a `NetworkDownloadTaskOperation` with the `manager`, using the controller's `<didWriteDataHandler>`
+ * and `<didFinishDownloadingHandler>`. The controller sets the operation's `bulk` property, and wraps its `completionBlock`.
+ */
+@property (nonatomic, copy) NetworkPrefetchOperationProvider operationProvider;
+
+/// -------------
+/// @name Metrics
+/// -------------
+
+/// The number of operations created.
+
+@property (nonatomic, readonly) NSUInteger startedCount;
+
+/// The number of times a URL that became visible reused the operation its near prefetch had already started.
+/// Updates that don't change a URL's visibility (e.g. successive `<updateVisibleRange:>` calls while scrolling) aren't counted.
+
+@property (nonatomic, readonly) NSUInteger reusedCount;
+
+/// The number of operations canceled because their URLs became far.
+
+@property (nonatomic, readonly) NSUInteger canceledCount;
+
+/// The number of operations created from resume data.
+
+@property (nonatomic, readonly) NSUInteger resumedCount;
+
+/// --------------------
+/// @name Initialization
+/// --------------------
+
+/** Create prefetch controller.
+ *
+ * @param manager The `NetworkManager` used to create and perform the downloads.
+ *
+ * @return        Returns `NetworkPrefetchController`.
+ */
+
+- (instancetype)initWithManager:(NetworkManager *)manager;
+
+/// ------------------
+/// @name Visibility
+/// ------------------
+
+/** Update the visibility of the `<urls>` for a new visible range.
+ *
+ * URLs in `range` are visible, those within `<nearDistance>` of it are near, and all others are far.
+ *
+ * @param range The range of indexes of `<urls>` that are visible.
+ */
+
+- (void)updateVisibleRange:(NSRange)range;
+
+/** Set the visibility of specific URLs, e.g. for lists whose items aren't contiguous.
+ *
+ * @param visibility The visibility.
+ * @param urls       An array of `NSURL`.
+ */
+
+- (void)setVisibility:(NetworkPrefetchVisibility)visibility forURLs:(NSArray *)urls;
+
+/** The current visibility of a URL.
+ *
+ * @param url The URL.
+ *
+ * @return The visibility, or `NetworkPrefetchVisibilityFar` if the URL is unknown.
+ */
+
+- (NetworkPrefetchVisibility)visibilityForURL:(NSURL *)url;
+
+/** The operation for a URL.
+ *
+ * @param url The URL.
+ *
+ * @return The operation in progress for the URL, or `nil` if there is none (or it has finished).
+ */
+
+- (NetworkTaskOperation *)operationForURL:(NSURL *)url;
+
+/** Forget the operations and resume data for URLs, so that they will be downloaded again when they next become near or visible.
+ *
+ * @param urls An array of `NSURL`.
+ */
+
+- (void)forgetURLs:(NSArray *)urls;
+
+/** Cancel all operations, and discard all resume data.
+ */
+
+- (void)cancelAll;
+
+@end
@@ -0,0 +1,330 @@
+//
+//  NetworkPrefetchController.m
+//
+//  Created by agent on 10/19/26.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+//  This work is licensed under a Creative Commons Attribution-ShareAlike 4.0 International License.
+//  http://creativecommons.org/licenses/by-sa/4.0/
+
+#import "NetworkPrefetchController.h"
+#import "NetworkManager.h"
+
+// the values of `NSURLSessionTaskPriorityHigh` and `NSURLSessionTaskPriorityLow`, which aren't available before iOS 8
+
+static float const kTaskPriorityHigh = 0.75;
+static float const kTaskPriorityLow  = 0.25;
+
+@interface NetworkPrefetchController ()
+
+@property (nonatomic, weak, readwrite) NetworkManager *manager;
+@property (nonatomic, strong) NSMutableDictionary *operations;
+@property (nonatomic, strong) NSMutableDictionary *visibilities;
+@property (nonatomic, strong) NSHashTable *canceledOperations;
+@property (nonatomic, strong) NSMutableOrderedSet *finishedURLs;
+@property (nonatomic, strong) NSCache *resumeData;
+
+@property (nonatomic, readwrite) NSUInteger startedCount;
+@property (nonatomic, readwrite) NSUInteger reusedCount;
+@property (nonatomic, readwrite) NSUInteger canceledCount;
+@property (nonatomic, readwrite) NSUInteger resumedCount;
+
+@end
+
+@implementation NetworkPrefetchController
+
+- (instancetype)initWithManager:(NetworkManager *)manager {
+    NSParameterAssert(manager);
+
+    self = [super init];
+    if (self) {
+        _manager = manager;
+        _operations = [[NSMutableDictionary alloc] init];
+        _visibilities = [[NSMutableDictionary alloc] init];
+        _canceledOperations = [NSHashTable weakObjectsHashTable];
+        _resumeData = [[NSCache alloc] init];
+        _finishedURLs = [[NSMutableOrderedSet alloc] init];
+        _finishedURLLimit = 1000;
+        _nearDistance = 10;
+        self.resumeDataLimit = 50;
+    }
+    return self;
+}
+
+- (void)setResumeDataLimit:(NSUInteger)resumeDataLimit {
+    _resumeDataLimit = resumeDataLimit;
+    self.resumeData.countLimit = resumeDataLimit;
+}
+
+#pragma mark - Visibility
+
+- (void)updateVisibleRange:(NSRange)range {
+    NSUInteger count = [self.urls count];
+    NSUInteger visibleStart = MIN(range.location, count);
+    NSUInteger visibleEnd = MIN(NSMaxRange(range), count);
+    NSUInteger nearStart = visibleStart > self.nearDistance ? visibleStart - self.nearDistance : 0;
+    NSUInteger nearEnd = MIN(visibleEnd + self.nearDistance, count);
+
+    // first, cancel whatever is now far, to free up the bandwidth for the rest
+
+    NSSet *windowURLs = [NSSet setWithArray:[self.urls subarrayWithRange:NSMakeRange(nearStart, nearEnd - nearStart)]];
+    NSMutableArray *farURLs = [NSMutableArray array];
+    @synchronized(self) {
+        for (NSURL *url in [self.visibilities allKeys]) {
+            if (![windowURLs containsObject:url])
+                [farURLs addObject:url];
+        }
+    }
+    [self setVisibility:NetworkPrefetchVisibilityFar forURLs:farURLs];
+
+    // then the visible ones, and then the near ones, nearest first
+
+    [self setVisibility:NetworkPrefetchVisibilityVisible forURLs:[self.urls subarrayWithRange:NSMakeRange(visibleStart, visibleEnd - visibleStart)]];
+
+    NSMutableArray *nearURLs = [NSMutableArray array];
+    for (NSUInteger distance = 1; distance <= self.nearDistance; distance++) {
+        if (visibleEnd + distance - 1 < nearEnd)
+            [nearURLs addObject:self.urls[visibleEnd + distance - 1]];
+        if (visibleStart >= nearStart + distance)
+            [nearURLs addObject:self.urls[visibleStart - distance]];
+    }
+    [self setVisibility:NetworkPrefetchVisibilityNear forURLs:nearURLs];
+}
+
+- (void)setVisibility:(NetworkPrefetchVisibility)visibility forURLs:(NSArray *)urls {
+    for (NSURL *url in urls) {
+        [self setVisibility:visibility forURL:url];
+    }
+}
+
+- (void)setVisibility:(NetworkPrefetchVisibility)visibility forURL:(NSURL *)url {
+    NetworkTaskOperation *operation;
+    NetworkPrefetchVisibility previousVisibility;
+    BOOL finished;
+
+    @synchronized(self) {
+        previousVisibility = [self.visibilities[url] integerValue];
+
+        if (visibility == NetworkPrefetchVisibilityFar)
+            [self.visibilities removeObjectForKey:url];
+        else
+            self.visibilities[url] = @(visibility);
+
+        operation = self.operations[url];
+        finished = [self.finishedURLs containsObject:url];
+    }
+
+    if (visibility == NetworkPrefetchVisibilityFar) {
+        if (operation && ![operation isFinished])
+            [self cancelOperation:operation forURL:url];
+        return;
+    }
+
+    if (operation) {
+        // an operation in progress is kept (one that has finished successfully means there's nothing left to do),
+        // but it only needs attention if its visibility changed, and it is only reused if a speculative
+        // download is now wanted for a visible item
+
+        if (![operation isFinished] && visibility != previousVisibility) {
+            [self setPriority:visibility ofOperation:operation];
+            if (visibility == NetworkPrefetchVisibilityVisible) {
+                @synchronized(self) {
+                    self.reusedCount++;
+                }
+            }
+        }
+        return;
+    }
+
+    // a URL whose download has finished successfully has nothing left to do
+
+    if (finished)
+        return;
+
+    [self startOperationForURL:url visibility:visibility];
+}
+
+- (NetworkPrefetchVisibility)visibilityForURL:(NSURL *)url {
+    @synchronized(self) {
+        return [self.visibilities[url] integerValue];
+    }
+}
+
+- (NetworkTaskOperation *)operationForURL:(NSURL *)url {
+    @synchronized(self) {
+        return self.operations[url];
+    }
+}
+
+#pragma mark - Operations
+
+- (void)setPriority:(NetworkPrefetchVisibility)visibility ofOperation:(NetworkTaskOperation *)operation {
+    BOOL visible = visibility == NetworkPrefetchVisibilityVisible;
+
+    operation.queuePriority = visible ? NSOperationQueuePriorityVeryHigh : NSOperationQueuePriorityVeryLow;
+
+    if ([operation.task respondsToSelector:@selector(setPriority:)])
+        operation.task.priority = visible ? kTaskPriorityHigh : kTaskPriorityLow;
+}
+
+- (void)startOperationForURL:(NSURL *)url visibility:(NetworkPrefetchVisibility)visibility {
+    NSData *resumeData = [self.resumeData objectForKey:url];
+    NetworkPrefetchOperationProvider provider = self.operationProvider ?: [self defaultOperationProvider];
+
+    NetworkTaskOperation *operation = provider(self, url, resumeData);
+    if (!operation)
+        return;
+
+    if (resumeData)
+        [self.resumeData removeObjectForKey:url];
+
+    @synchronized(self) {
+        self.operations[url] = operation;
+        self.startedCount++;
+        if (resumeData)
+            self.resumedCount++;
+    }
+
+    // speculative downloads are the first thing to go under memory pressure
+
+    operation.bulk = YES;
+
+    // once it finishes, let go of the operation (and whatever it holds), remembering only the URL if it succeeded
+
+    __weak NetworkPrefetchController *weakSelf = self;
+    __weak NetworkTaskOperation *weakOperation = operation;
+    void (^completionBlock)(void) = operation.completionBlock;
+
+    operation.completionBlock = ^{
+        if (completionBlock)
+            completionBlock();
+
+        [weakSelf operationDidFinish:weakOperation forURL:url];
+    };
+
+    [self setPriority:visibility ofOperation:operation];
+    [self.manager addOperation:operation];
+}
+
+/* Remove a finished operation. One that was neither canceled nor failed (a failed download has already been
+ * removed by its handler, so that it can be retried) has its URL added to the finished URLs, oldest of which are
+ * forgotten once there are more than `finishedURLLimit`.
+ */
+- (void)operationDidFinish:(NetworkTaskOperation *)operation forURL:(NSURL *)url {
+    if (!operation)
+        return;
+
+    @synchronized(self) {
+        if (self.operations[url] != operation)
+            return;
+
+        [self.operations removeObjectForKey:url];
+
+        if ([operation isCancelled] || [self.canceledOperations containsObject:operation])
+            return;
+
+        [self.finishedURLs removeObject:url];
+        [self.finishedURLs addObject:url];
+
+        if ([self.finishedURLs count] > self.finishedURLLimit)
+            [self.finishedURLs removeObjectsInRange:NSMakeRange(0, [self.finishedURLs count] - self.finishedURLLimit)];
+    }
+}
+
+- (void)cancelOperation:(NetworkTaskOperation *)operation forURL:(NSURL *)url {
+    @synchronized(self) {
+        [self.canceledOperations addObject:operation];
+        [self.operations removeObjectForKey:url];
+        self.canceledCount++;
+    }
+
+    // a download that hasn't started has nothing to resume from, so just cancel it
+
+    if ([operation isKindOfClass:[NetworkDownloadTaskOperation class]] && [operation isExecuting]) {
+        [(NetworkDownloadTaskOperation *)operation cancelByProducingResumeData:^(NSData *resumeData) {
+            if (resumeData)
+                [self.resumeData setObject:resumeData forKey:url];
+        }];
+    } else {
+        [operation cancel];
+    }
+}
+
+- (NetworkPrefetchOperationProvider)defaultOperationProvider {
+    return ^NetworkTaskOperation *(NetworkPrefetchController *controller, NSURL *url, NSData *resumeData) {
+        __weak NetworkPrefetchController *weakController = controller;
+
+        DidWriteDataHandler didWriteDataHandler = ^(NetworkDownloadTaskOperation *operation, int64_t bytesWritten, int64_t totalBytesWritten, int64_t totalBytesExpectedToWrite) {
+            DidWriteDataHandler handler = weakController.didWriteDataHandler;
+            if (handler)
+                handler(operation, bytesWritten, totalBytesWritten, totalBytesExpectedToWrite);
+        };
+
+        DidFinishDownloadingHandler didFinishDownloadingHandler = ^(NetworkDownloadTaskOperation *operation, NSURL *location, NSError *error) {
+            NetworkPrefetchController *strongController = weakController;
+            if (!strongController)
+                return;
+
+            if (error) {
+                // the controller canceled it, so no one needs to know; otherwise forget it, so it can be retried
+
+                @synchronized(strongController) {
+                    if ([strongController.canceledOperations containsObject:operation])
+                        return;
+                    if (strongController.operations[url] == operation)
+                        [strongController.operations removeObjectForKey:url];
+                }
+            }
+
+            if (strongController.didFinishDownloadingHandler)
+                strongController.didFinishDownloadingHandler(operation, location, error);
+        };
+
+        if (resumeData)
+            return [controller.manager downloadOperationWithResumeData:resumeData didWriteDataHandler:didWriteDataHandler didFinishDownloadingHandler:didFinishDownloadingHandler];
+
+        return [controller.manager downloadOperationWithURL:url didWriteDataHandler:didWriteDataHandler didFinishDownloadingHandler:didFinishDownloadingHandler];
+    };
+}
+
+- (void)forgetURLs:(NSArray *)urls {
+    for (NSURL *url in urls) {
+        NetworkTaskOperation *operation;
+
+        @synchronized(self) {
+            operation = self.operations[url];
+        }
+
+        @synchronized(self) {
+            if (operation)
+                [self.canceledOperations addObject:operation];
+            [self.operations removeObjectForKey:url];
+            [self.finishedURLs removeObject:url];
+        }
+
+        [operation cancel];
+        [self.resumeData removeObjectForKey:url];
+    }
+}
+
+- (void)cancelAll {
+    NSDictionary *operations;
+
+    @synchronized(self) {
+        operations = [self.operations copy];
+        [self.operations removeAllObjects];
+        [self.visibilities removeAllObjects];
+        [self.finishedURLs removeAllObjects];
+        for (NetworkTaskOperation *operation in [operations allValues]) {
+            [self.canceledOperations addObject:operation];
+        }
+    }
+
+    for (NetworkTaskOperation *operation in [operations allValues]) {
+        [operation cancel];
+    }
+
+    [self.resumeData removeAllObjects];
+}
+
+@end
@@ -0,0 +1,115 @@
+//
+//  NetworkRequestBatcher.h
+//
+//  Created by agent on 10/19/26.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+//  This work is licensed under a Creative Commons Attribution-ShareAlike 4.0 International License.
+//  http://creativecommons.org/licenses/by-sa/4.0/
+
+#import <Foundation/Foundation.h>
+#import "NetworkBatchEnvelope.h"
+
+@class NetworkManager;
+
+typedef void(^NetworkBatchItemCompletionHandler)(NSHTTPURLResponse *response,
+                                                 NSData *data,
+                                                 NSError *error);
+
+/** Combines small requests to the same origin into a single batch request.
+
+ Rather than each small request taking its own task (and its own slot in the manager's `networkQueue`),
+ requests passed to `<enqueueRequest:completionHandler:>` are collected, per origin (scheme, host and port),
+ for up to `<batchWindow>` seconds or until `<maximumBatchSize>` have been collected. They are then combined,
+ by the `<envelope>`, into a single request to the origin's `<batchPath>`, performed as one
+ `NetworkDataTaskOperation`. The batch response is split back into a response for each request,
+ and each request's completion handler is called with its own response (or error).
+
+ A batch of one request is sent as is, without an envelope.
+
+ The batch request itself carries the request-level headers listed in `<sharedHeaderFields>` (by default,
+ `Authorization` and `Cookie`), so only requests whose values for those headers match (e.g. requests with the same
+ credentials, or requests without any) are combined, and the batch request is sent with those values.
+
+ When assigned to the `requestBatcher` property of a `<NetworkManager>`, the `NetworkManager (HTTP)` method
+ `post:parameters:completion:` sends its requests through the batcher.
+ */
+
+@interface NetworkRequestBatcher : NSObject
+
+/// ----------------
+/// @name Properties
+/// ----------------
+
+/// The manager used to perform the batch requests.
+
+@property (nonatomic, weak, readonly) NetworkManager *manager;
+
+/// The envelope used to combine the requests and split the responses.
+
+@property (nonatomic, strong, readonly) id<NetworkBatchEnvelope> envelope;
+
+/// The path, on each origin, of the batch endpoint. Default is `@"/batch"`.
+
+@property (nonatomic, copy) NSString *batchPath;
+
+/// The maximum number of seconds a request waits for others to join its batch. Default is 0.05 seconds.
+
+@property (nonatomic) NSTimeInterval batchWindow;
+
+/// The maximum number of requests in a batch. When this many have been collected, the batch is sent right away. Default is 20.
+
+@property (nonatomic) NSUInteger maximumBatchSize;
+
+/** The header fields that must match for requests to be combined, and that are copied onto the batch request.
+ *
+ * These are the headers a server looks at for the request as a whole (e.g. to authenticate it), rather than for each
+ * request in the envelope. Default is `@[@"Authorization", @"Cookie"]`. Add any other such header (e.g. an API key).
+ */
+
+@property (nonatomic, copy) NSArray *sharedHeaderFields;
+
+/// --------------------
+/// @name Initialization
+/// --------------------
+
+/** Create request batcher.
+ *
+ * @param manager  The `NetworkManager` used to perform the batch requests.
+ * @param envelope The envelope used to combine the requests and split the responses, e.g. `NetworkJSONBatchEnvelope`.
+ *
+ * @return         Returns `NetworkRequestBatcher`.
+ */
+
+- (instancetype)initWithManager:(NetworkManager *)manager envelope:(id<NetworkBatchEnvelope>)envelope;
+
+/// ------------------
+/// @name Batching
+/// ------------------
+
+/** Add request to the next batch for its origin.
+ *
+ * The completion handler is called on the manager's `completionQueue` (or the main queue, if it is `nil`) with:
+ *
+ * - the request's own response and data; and
+ * - an error if the batch request failed, if the batch response had no response for this request, or if the
+ *   request's own status code was not 2xx (in which case the error is the same as a `NetworkDataTaskOperation` would report).
+ *
+ * This uses the following typedef:
+ *
+ *     typedef void(^NetworkBatchItemCompletionHandler)(NSHTTPURLResponse *response,
+ *                                                      NSData *data,
+ *                                                      NSError *error);
+ *
+ * @param request           The request. Its body must be in `HTTPBody` (not `HTTPBodyStream`).
+ * @param completionHandler The block called when the request completes (or fails).
+ */
+
+- (void)enqueueRequest:(NSURLRequest *)request completionHandler:(NetworkBatchItemCompletionHandler)completionHandler;
+
+/** Send all of the batches that are being collected now, rather than waiting for their windows to elapse.
+ */
+
+- (void)flush;
+
+@end
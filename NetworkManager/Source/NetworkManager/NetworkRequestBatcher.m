@@ -0,0 +1,220 @@
+//
+//  NetworkRequestBatcher.m
+//
+//  Created by agent on 10/19/26.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+//  This work is licensed under a Creative Commons Attribution-ShareAlike 4.0 International License.
+//  http://creativecommons.org/licenses/by-sa/4.0/
+
+#import "NetworkRequestBatcher.h"
+#import "NetworkManager.h"
+
+/** A request waiting to be sent in a batch.
+ */
+@interface NetworkBatchItem : NSObject
+@property (nonatomic, copy) NSURLRequest *request;
+@property (nonatomic, copy) NetworkBatchItemCompletionHandler completionHandler;
+@end
+
+@implementation NetworkBatchItem
+@end
+
+
+@interface NetworkRequestBatcher ()
+
+@property (nonatomic, weak, readwrite) NetworkManager *manager;
+@property (nonatomic, strong, readwrite) id<NetworkBatchEnvelope> envelope;
+@property (nonatomic, strong) NSMutableDictionary *pendingBatches;
+@property (nonatomic, strong) dispatch_queue_t batchQueue;
+
+@end
+
+@implementation NetworkRequestBatcher
+
+- (instancetype)initWithManager:(NetworkManager *)manager envelope:(id<NetworkBatchEnvelope>)envelope {
+    NSParameterAssert(manager);
+    NSParameterAssert(envelope);
+
+    self = [super init];
+    if (self) {
+        _manager = manager;
+        _envelope = envelope;
+        _pendingBatches = [[NSMutableDictionary alloc] init];
+        _batchQueue = dispatch_queue_create("NetworkRequestBatcher", DISPATCH_QUEUE_SERIAL);
+        _batchPath = @"/batch";
+        _batchWindow = 0.05;
+        _maximumBatchSize = 20;
+        _sharedHeaderFields = @[@"Authorization", @"Cookie"];
+    }
+    return self;
+}
+
+#pragma mark - Batching
+
+- (NSString *)originForURL:(NSURL *)url {
+    NSString *scheme = [url.scheme lowercaseString];
+    NSNumber *port = url.port ?: ([scheme isEqualToString:@"https"] ? @443 : @80);
+
+    return [NSString stringWithFormat:@"%@://%@:%@", scheme, [url.host lowercaseString], port];
+}
+
+/* The key of the batch a request can join: its origin and the values of its `sharedHeaderFields`, since the batch
+ * request carries those for all of its items.
+ */
+- (NSString *)batchKeyForRequest:(NSURLRequest *)request {
+    NSMutableString *key = [[self originForURL:request.URL] mutableCopy];
+
+    for (NSString *field in self.sharedHeaderFields) {
+        [key appendFormat:@"\n%@: %@", [field lowercaseString], [request valueForHTTPHeaderField:field] ?: @""];
+    }
+
+    return key;
+}
+
+- (void)enqueueRequest:(NSURLRequest *)request completionHandler:(NetworkBatchItemCompletionHandler)completionHandler {
+    NSParameterAssert(request);
+    NSAssert(!request.HTTPBodyStream, @"%s: requests with an HTTPBodyStream cannot be batched", __FUNCTION__);
+
+    NetworkBatchItem *item = [[NetworkBatchItem alloc] init];
+    item.request = request;
+    item.completionHandler = completionHandler;
+
+    NSString *key = [self batchKeyForRequest:request];
+
+    dispatch_async(self.batchQueue, ^{
+        NSMutableArray *batch = self.pendingBatches[key];
+
+        if (!batch) {
+            batch = [NSMutableArray array];
+            self.pendingBatches[key] = batch;
+
+            // the first request of a batch starts its window
+
+            __weak NetworkRequestBatcher *weakSelf = self;
+            dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(self.batchWindow * NSEC_PER_SEC)), self.batchQueue, ^{
+                [weakSelf sendBatch:batch forKey:key];
+            });
+        }
+
+        [batch addObject:item];
+
+        if ([batch count] >= self.maximumBatchSize)
+            [self sendBatch:batch forKey:key];
+    });
+}
+
+- (void)flush {
+    dispatch_async(self.batchQueue, ^{
+        for (NSString *key in [self.pendingBatches allKeys]) {
+            [self sendBatch:self.pendingBatches[key] forKey:key];
+        }
+    });
+}
+
+/* Send a batch, unless it has already been sent (e.g. because it filled up before its window elapsed).
+ *
+ * This must be called on the `batchQueue`.
+ */
+- (void)sendBatch:(NSMutableArray *)batch forKey:(NSString *)key {
+    if (self.pendingBatches[key] != batch)
+        return;
+
+    [self.pendingBatches removeObjectForKey:key];
+
+    NetworkManager *manager = self.manager;
+    if (!manager)
+        return;
+
+    if ([batch count] == 1) {
+        [self sendItem:[batch firstObject] manager:manager];
+        return;
+    }
+
+    NSArray *requests = [batch valueForKey:@"request"];
+    NSURLRequest *firstRequest = [requests firstObject];
+    NSURL *url = [NSURL URLWithString:self.batchPath relativeToURL:[NSURL URLWithString:[self originForURL:firstRequest.URL]]];
+    NSURLRequest *batchRequest = [self.envelope batchRequestWithURL:[url absoluteURL] requests:requests];
+
+    // every item of the batch has the same credentials, so the batch request is sent with them
+
+    if (batchRequest) {
+        NSMutableURLRequest *mutableRequest = [batchRequest mutableCopy];
+        for (NSString *field in self.sharedHeaderFields) {
+            NSString *value = [firstRequest valueForHTTPHeaderField:field];
+            if (value)
+                [mutableRequest setValue:value forHTTPHeaderField:field];
+        }
+        batchRequest = mutableRequest;
+    }
+
+    if (!batchRequest) {
+        NSError *error = [NSError errorWithDomain:kNetworkBatchEnvelopeErrorDomain code:NetworkBatchEnvelopeErrorCodeMalformedResponse userInfo:@{NSLocalizedDescriptionKey: @"Requests could not be combined into a batch"}];
+        dispatch_async(manager.completionQueue ?: dispatch_get_main_queue(), ^{
+            [self completeItems:batch withError:error];
+        });
+        return;
+    }
+
+    NetworkDataTaskOperation *operation = [manager dataOperationWithRequest:batchRequest progressHandler:nil completionHandler:^(NetworkTaskOperation *operation, NSData *data, NSError *error) {
+        if (error) {
+            [self completeItems:batch withError:error];
+            return;
+        }
+
+        NSError *envelopeError;
+        NSArray *itemResponses = [self.envelope itemResponsesWithData:data response:(NSHTTPURLResponse *)operation.task.response requests:requests error:&envelopeError];
+        if (!itemResponses) {
+            [self completeItems:batch withError:envelopeError];
+            return;
+        }
+
+        [batch enumerateObjectsUsingBlock:^(NetworkBatchItem *item, NSUInteger idx, BOOL *stop) {
+            id itemResponse = idx < [itemResponses count] ? itemResponses[idx] : nil;
+
+            if (![itemResponse isKindOfClass:[NetworkBatchItemResponse class]]) {
+                if (item.completionHandler)
+                    item.completionHandler(nil, nil, itemResponse);
+                return;
+            }
+
+            [self completeItem:item response:[itemResponse response] data:[itemResponse data]];
+        }];
+    }];
+
+    [manager addOperation:operation];
+}
+
+/* A batch of one is just sent by itself.
+ */
+- (void)sendItem:(NetworkBatchItem *)item manager:(NetworkManager *)manager {
+    NetworkDataTaskOperation *operation = [manager dataOperationWithRequest:item.request progressHandler:nil completionHandler:^(NetworkTaskOperation *operation, NSData *data, NSError *error) {
+        if (item.completionHandler)
+            item.completionHandler((NSHTTPURLResponse *)operation.task.response, data, error);
+    }];
+
+    [manager addOperation:operation];
+}
+
+#pragma mark - Completion
+
+- (void)completeItem:(NetworkBatchItem *)item response:(NSHTTPURLResponse *)response data:(NSData *)data {
+    NSError *error;
+
+    // report an unsuccessful status the way NetworkDataTaskOperation would have, had the request been sent by itself
+
+    if (response.statusCode < 200 || response.statusCode >= 300)
+        error = [NSError errorWithDomain:NSStringFromClass([NetworkDataTaskOperation class]) code:response.statusCode userInfo:@{@"statusCode": @(response.statusCode), @"response": response}];
+
+    if (item.completionHandler)
+        item.completionHandler(response, data, error);
+}
+
+- (void)completeItems:(NSArray *)items withError:(NSError *)error {
+    for (NetworkBatchItem *item in items) {
+        if (item.completionHandler)
+            item.completionHandler(nil, nil, error);
+    }
+}
+
+@end
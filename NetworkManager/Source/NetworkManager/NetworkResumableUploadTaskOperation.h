@@ -0,0 +1,92 @@
+//
+//  NetworkResumableUploadTaskOperation.h
+//
+//  Created by agent on 10/19/26.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+//  This work is licensed under a Creative Commons Attribution-ShareAlike 4.0 International License.
+//  http://creativecommons.org/licenses/by-sa/4.0/
+
+#import <Foundation/Foundation.h>
+#import "NetworkTaskOperation.h"
+
+@class NetworkManager;
+
+/** Resumable, chunked upload of a file.
+
+ Rather than sending the whole file in one task, this splits it into `<chunkSize>` chunks, reading each one
+ from disk only when it is about to be sent, and uploads them using the tus core protocol:
+
+ 1. `POST` to the request's URL with an `Upload-Length` header. The server responds with `201 Created` and
+    a `Location` header identifying the upload.
+
+ 2. `PATCH` each chunk to that location with `Upload-Offset` and `Content-Type: application/offset+octet-stream`
+    headers. The server responds with `204 No Content` (or `200 OK`) once the chunk is stored.
+
+ 3. When resuming, `HEAD` the location. The server responds with the `Upload-Offset` up to which it has
+    contiguously received the file. That offset (rather than the saved progress) decides what is sent next, and
+    if it falls in the middle of a chunk, the first `PATCH` sends only the rest of that chunk.
+
+ Every request also carries a `Tus-Resumable: 1.0.0` header. The tus core protocol requires each `PATCH` to start
+ at the server's current offset, so by default the chunks are sent one at a time, in order.
+
+ Progress (the upload location and the acknowledged chunks) is saved in the application support directory
+ after every chunk. If the upload is interrupted, even by the app being terminated, creating a new operation
+ for the same URL and (unmodified) file will pick up where the previous one left off.
+
+ The `didSendBodyDataHandler` reports aggregate progress across all chunks, and `didCompleteWithDataErrorHandler`
+ is called once, when the whole file has been uploaded or when the upload fails.
+ */
+
+@interface NetworkResumableUploadTaskOperation : NetworkTaskOperation
+
+/// ----------------
+/// @name Properties
+/// ----------------
+
+/// The size of each chunk, in bytes. Default is 4 MB. This must be set before the operation starts.
+
+@property (nonatomic) int64_t chunkSize;
+
+/** The maximum number of chunks uploaded concurrently. Default is 1. This must be set before the operation starts.
+
+ @warning With more than one chunk in flight, `PATCH` requests arrive with an `Upload-Offset` ahead of the server's
+ current offset, which a tus core server rejects with `409 Conflict`. Only raise this for a server that accepts
+ chunks out of order.
+ */
+
+@property (nonatomic) NSUInteger maximumConcurrentChunks;
+
+/// The URL of the upload on the server, once it has been created (or recovered from saved progress).
+
+@property (nonatomic, strong, readonly) NSURL *uploadURL;
+
+/// --------------------
+/// @name Initialization
+/// --------------------
+
+/** Initialize resumable upload operation.
+ *
+ * This is generally instantiated by `<NetworkManager>` method `resumableUploadOperationWithRequest:fileURL:didSendBodyDataHandler:didCompleteWithDataErrorHandler:`.
+ *
+ * @param manager The `<NetworkManager>` used to create the individual chunk tasks.
+ * @param request The `NSURLRequest` whose URL is the upload creation endpoint. Its headers are included in every request.
+ * @param fileURL The file `NSURL` of the file to be uploaded.
+ *
+ * @return        Returns `NetworkResumableUploadTaskOperation`.
+ */
+
+- (instancetype)initWithManager:(NetworkManager *)manager
+                        request:(NSURLRequest *)request
+                        fileURL:(NSURL *)fileURL;
+
+/// -----------------------
+/// @name Saved progress
+/// -----------------------
+
+/** Discard any saved progress for this upload, so that the next attempt starts from the beginning.
+ */
+
+- (void)discardSavedProgress;
+
+@end
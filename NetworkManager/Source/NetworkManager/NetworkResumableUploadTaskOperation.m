@@ -0,0 +1,479 @@
+//
+//  NetworkResumableUploadTaskOperation.m
+//
+//  Created by agent on 10/19/26.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+//  This work is licensed under a Creative Commons Attribution-ShareAlike 4.0 International License.
+//  http://creativecommons.org/licenses/by-sa/4.0/
+
+#import "NetworkResumableUploadTaskOperation.h"
+#import "NetworkManager.h"
+#import <CommonCrypto/CommonDigest.h>
+
+static NSString * const kTusResumableVersion = @"1.0.0";
+
+@interface NetworkResumableUploadTaskOperation ()
+
+@property (nonatomic, strong) NetworkManager *manager;
+@property (nonatomic, copy)   NSURLRequest *request;
+@property (nonatomic, strong) NSURL *fileURL;
+@property (nonatomic, strong, readwrite) NSURL *uploadURL;
+
+@property (nonatomic) int64_t fileLength;
+@property (nonatomic, strong) NSDate *fileModificationDate;
+@property (nonatomic, strong) NSFileHandle *fileHandle;
+
+@property (nonatomic, strong) NSMutableIndexSet *acknowledgedChunks;
+@property (nonatomic) int64_t acknowledgedBytes;
+@property (nonatomic) int64_t serverOffset;
+@property (nonatomic) NSUInteger nextChunkIndex;
+@property (nonatomic, strong) NSMutableDictionary *chunkOperations;
+@property (nonatomic, strong) NSMutableDictionary *chunkBytesSent;
+@property (nonatomic, strong) NetworkDataTaskOperation *controlOperation;
+
+@property (nonatomic, strong) NSError *error;
+@property (nonatomic, getter = isUploadFinished) BOOL uploadFinished;
+@property (nonatomic, strong) dispatch_queue_t stateQueue;
+
+@end
+
+@implementation NetworkResumableUploadTaskOperation
+
+- (instancetype)initWithManager:(NetworkManager *)manager
+                        request:(NSURLRequest *)request
+                        fileURL:(NSURL *)fileURL {
+    NSParameterAssert(manager);
+    NSParameterAssert(request);
+    NSParameterAssert(fileURL);
+
+    self = [super init];
+    if (self) {
+        _manager = manager;
+        _request = [request copy];
+        _fileURL = fileURL;
+        _chunkSize = 4 * 1024 * 1024;
+        _maximumConcurrentChunks = 1;
+        _acknowledgedChunks = [[NSMutableIndexSet alloc] init];
+        _chunkOperations = [[NSMutableDictionary alloc] init];
+        _chunkBytesSent = [[NSMutableDictionary alloc] init];
+        _stateQueue = dispatch_queue_create("NetworkResumableUploadTaskOperation", DISPATCH_QUEUE_SERIAL);
+    }
+    return self;
+}
+
+- (void)start {
+    [super start];
+
+    if (![self isExecuting])
+        return;
+
+    dispatch_async(self.stateQueue, ^{
+        [self prepareUpload];
+    });
+}
+
+- (void)cancel {
+    [super cancel];
+
+    dispatch_async(self.stateQueue, ^{
+        [self.controlOperation cancel];
+        for (NetworkDataTaskOperation *operation in [self.chunkOperations allValues]) {
+            [operation cancel];
+        }
+    });
+}
+
+#pragma mark - Upload steps
+
+/* Determine the size of the file and whether we have saved progress for it, and then either create
+ * the upload on the server or ask the server how much of it it already has.
+ */
+- (void)prepareUpload {
+    NSError *error;
+
+    NSDictionary *attributes = [[NSFileManager defaultManager] attributesOfItemAtPath:[self.fileURL path] error:&error];
+    if (!attributes) {
+        [self finishWithError:error];
+        return;
+    }
+
+    self.fileLength = [attributes fileSize];
+    self.fileModificationDate = [attributes fileModificationDate];
+
+    self.fileHandle = [NSFileHandle fileHandleForReadingFromURL:self.fileURL error:&error];
+    if (!self.fileHandle) {
+        [self finishWithError:error];
+        return;
+    }
+
+    [self loadSavedProgress];
+
+    if (self.uploadURL) {
+        [self fetchServerOffset];
+    } else {
+        [self createUpload];
+    }
+}
+
+- (void)createUpload {
+    NSMutableURLRequest *request = [self requestWithURL:self.request.URL method:@"POST"];
+    [request setValue:[@(self.fileLength) stringValue] forHTTPHeaderField:@"Upload-Length"];
+
+    [self startControlOperationWithRequest:request completionHandler:^(NSHTTPURLResponse *response, NSError *error) {
+        NSString *location = [self valueForHeaderField:@"Location" inResponse:response];
+
+        if (!error && !location) {
+            error = [self errorForResponse:response];
+        }
+
+        if (error) {
+            [self finishWithError:error];
+            return;
+        }
+
+        self.uploadURL = [[NSURL URLWithString:location relativeToURL:self.request.URL] absoluteURL];
+        [self saveProgress];
+        [self scheduleChunks];
+    }];
+}
+
+- (void)fetchServerOffset {
+    NSMutableURLRequest *request = [self requestWithURL:self.uploadURL method:@"HEAD"];
+
+    [self startControlOperationWithRequest:request completionHandler:^(NSHTTPURLResponse *response, NSError *error) {
+        NSInteger statusCode = [response statusCode];
+
+        // the server no longer knows about this upload, so start over
+
+        if (statusCode == 403 || statusCode == 404 || statusCode == 410) {
+            [self discardSavedProgress];
+            self.uploadURL = nil;
+            [self.acknowledgedChunks removeAllIndexes];
+            self.acknowledgedBytes = 0;
+            self.serverOffset = 0;
+            [self createUpload];
+            return;
+        }
+
+        NSString *offsetString = [self valueForHeaderField:@"Upload-Offset" inResponse:response];
+
+        if (!error && !offsetString) {
+            error = [self errorForResponse:response];
+        }
+
+        if (error) {
+            [self finishWithError:error];
+            return;
+        }
+
+        int64_t offset = MIN(MAX([offsetString longLongValue], 0), self.fileLength);
+
+        // the server's offset is the only thing that counts: the saved progress may be ahead of it (e.g. the server
+        // lost a chunk) or behind it (e.g. the app was terminated before saving), and a tus server keeps the part of
+        // an interrupted `PATCH` that it received, so the offset may fall in the middle of a chunk
+
+        [self.acknowledgedChunks removeAllIndexes];
+
+        NSUInteger chunkCount = [self chunkCount];
+        for (NSUInteger index = 0; index < chunkCount; index++) {
+            if ([self offsetOfChunkAtIndex:index] + [self lengthOfChunkAtIndex:index] <= offset)
+                [self.acknowledgedChunks addIndex:index];
+        }
+
+        self.serverOffset = offset;
+        self.acknowledgedBytes = offset;
+
+        [self saveProgress];
+        [self scheduleChunks];
+    }];
+}
+
+/* Start as many chunk uploads as `maximumConcurrentChunks` permits, or finish if there's nothing left to do.
+ */
+- (void)scheduleChunks {
+    if ([self isCancelled] && !self.error) {
+        self.error = [NSError errorWithDomain:NSURLErrorDomain code:NSURLErrorCancelled userInfo:nil];
+    }
+
+    if (self.error) {
+        if ([self.chunkOperations count] == 0)
+            [self finishWithError:self.error];
+        return;
+    }
+
+    NSUInteger chunkCount = [self chunkCount];
+
+    if ([self.acknowledgedChunks count] == chunkCount) {
+        [self discardSavedProgress];
+        [self finishWithError:nil];
+        return;
+    }
+
+    while ([self.chunkOperations count] < MAX(self.maximumConcurrentChunks, 1) && self.nextChunkIndex < chunkCount) {
+        NSUInteger index = self.nextChunkIndex++;
+
+        if (![self.acknowledgedChunks containsIndex:index])
+            [self uploadChunkAtIndex:index];
+
+        if (self.error)
+            break;
+    }
+
+    if (self.error) {
+        if ([self.chunkOperations count] == 0) {
+            [self finishWithError:self.error];
+        } else {
+            for (NetworkDataTaskOperation *operation in [self.chunkOperations allValues]) {
+                [operation cancel];
+            }
+        }
+    }
+}
+
+- (void)uploadChunkAtIndex:(NSUInteger)index {
+    int64_t offset = [self unsentOffsetOfChunkAtIndex:index];
+    int64_t length = [self offsetOfChunkAtIndex:index] + [self lengthOfChunkAtIndex:index] - offset;
+
+    // read the chunk only now, so we never hold more than `maximumConcurrentChunks` chunks in memory
+
+    [self.fileHandle seekToFileOffset:offset];
+    NSData *data = [self.fileHandle readDataOfLength:(NSUInteger)length];
+
+    if ((int64_t)[data length] != length) {
+        self.error = [NSError errorWithDomain:NSCocoaErrorDomain code:NSFileReadUnknownError userInfo:@{NSURLErrorKey: self.fileURL}];
+        return;
+    }
+
+    NSMutableURLRequest *request = [self requestWithURL:self.uploadURL method:@"PATCH"];
+    [request setValue:[@(offset) stringValue] forHTTPHeaderField:@"Upload-Offset"];
+    [request setValue:@"application/offset+octet-stream" forHTTPHeaderField:@"Content-Type"];
+    [request setValue:[@(length) stringValue] forHTTPHeaderField:@"Content-Length"];
+
+    // the chunk is already in memory, so send it as the body of a data task (which, unlike an upload task's body,
+    // is visible to `NSURLProtocol` subclasses and is resent by the session itself after a redirect or challenge)
+
+    [request setHTTPBody:data];
+
+    NetworkDataTaskOperation *operation = [self.manager dataOperationWithRequest:request progressHandler:nil completionHandler:^(NetworkTaskOperation *operation, NSData *data, NSError *error) {
+        [self chunkAtIndex:index didCompleteWithResponse:(NSHTTPURLResponse *)operation.task.response error:error];
+    }];
+    operation.didSendBodyDataHandler = ^(NetworkTaskOperation *operation, int64_t bytesSent, int64_t totalBytesSent, int64_t totalBytesExpectedToSend) {
+        self.chunkBytesSent[@(index)] = @(totalBytesSent);
+        [self reportProgressWithBytesSent:bytesSent];
+    };
+
+    self.chunkOperations[@(index)] = operation;
+    [self startInternalOperation:operation];
+}
+
+- (void)chunkAtIndex:(NSUInteger)index didCompleteWithResponse:(NSHTTPURLResponse *)response error:(NSError *)error {
+    [self.chunkOperations removeObjectForKey:@(index)];
+    [self.chunkBytesSent removeObjectForKey:@(index)];
+
+    NSInteger statusCode = [response statusCode];
+
+    if (!error && statusCode != 200 && statusCode != 204) {
+        error = [self errorForResponse:response];
+    }
+
+    if (error) {
+        if (!self.error) {
+            self.error = error;
+            for (NetworkDataTaskOperation *operation in [self.chunkOperations allValues]) {
+                [operation cancel];
+            }
+        }
+    } else {
+        self.acknowledgedBytes += [self offsetOfChunkAtIndex:index] + [self lengthOfChunkAtIndex:index] - [self unsentOffsetOfChunkAtIndex:index];
+        [self.acknowledgedChunks addIndex:index];
+        [self saveProgress];
+    }
+
+    [self scheduleChunks];
+}
+
+- (void)finishWithError:(NSError *)error {
+    if ([self isUploadFinished])
+        return;
+
+    self.uploadFinished = YES;
+
+    [self.fileHandle closeFile];
+    self.fileHandle = nil;
+
+    if (self.didCompleteWithDataErrorHandler) {
+        [self performHandlerNamed:"didComplete" bytes:-1 block:^{
+            self.didCompleteWithDataErrorHandler(self, nil, error);
+            self.didCompleteWithDataErrorHandler = nil;
+        }];
+    }
+
+    self.didSendBodyDataHandler = nil;
+    self.manager = nil;
+
+    [self completeOperation];
+}
+
+- (void)reportProgressWithBytesSent:(int64_t)bytesSent {
+    if (!self.didSendBodyDataHandler)
+        return;
+
+    int64_t totalBytesSent = self.acknowledgedBytes;
+    for (NSNumber *chunkBytesSent in [self.chunkBytesSent allValues]) {
+        totalBytesSent += [chunkBytesSent longLongValue];
+    }
+
+    [self performHandlerNamed:"didSendBodyData" bytes:totalBytesSent block:^{
+        self.didSendBodyDataHandler(self, bytesSent, totalBytesSent, self.fileLength);
+    }];
+}
+
+#pragma mark - Requests
+
+- (NSMutableURLRequest *)requestWithURL:(NSURL *)url method:(NSString *)method {
+    NSMutableURLRequest *request = [self.request mutableCopy];
+    request.URL = url;
+    request.HTTPMethod = method;
+    request.HTTPBody = nil;
+    request.cachePolicy = NSURLRequestReloadIgnoringLocalCacheData;
+    [request setValue:kTusResumableVersion forHTTPHeaderField:@"Tus-Resumable"];
+
+    return request;
+}
+
+/* Start a creation (POST) or offset (HEAD) request.
+ */
+- (void)startControlOperationWithRequest:(NSURLRequest *)request completionHandler:(void (^)(NSHTTPURLResponse *response, NSError *error))completionHandler {
+    NetworkDataTaskOperation *operation = [self.manager dataOperationWithRequest:request progressHandler:nil completionHandler:^(NetworkTaskOperation *operation, NSData *data, NSError *error) {
+        self.controlOperation = nil;
+
+        NSHTTPURLResponse *response = (NSHTTPURLResponse *)operation.task.response;
+        if (!error && ![response isKindOfClass:[NSHTTPURLResponse class]]) {
+            error = [NSError errorWithDomain:NSURLErrorDomain code:NSURLErrorBadServerResponse userInfo:nil];
+        }
+
+        completionHandler(response, error);
+    }];
+
+    self.controlOperation = operation;
+    [self startInternalOperation:operation];
+}
+
+/* Our own requests don't go through the manager's `networkQueue` (this operation already holds one slot there),
+ * and their handlers run on our serial `stateQueue`, which is what protects our bookkeeping.
+ */
+- (void)startInternalOperation:(NetworkDataTaskOperation *)operation {
+    operation.completionQueue = self.stateQueue;
+
+    // we interpret the status codes ourselves (e.g. 201 and 204 are success), so accept every response
+
+    operation.didReceiveResponseHandler = ^(NetworkDataTaskOperation *operation, NSURLResponse *response, void(^completionHandler)(NSURLSessionResponseDisposition disposition)) {
+        completionHandler(NSURLSessionResponseAllow);
+    };
+
+    [operation start];
+}
+
+- (NSString *)valueForHeaderField:(NSString *)field inResponse:(NSHTTPURLResponse *)response {
+    for (NSString *headerKey in response.allHeaderFields) {
+        if ([headerKey caseInsensitiveCompare:field] == NSOrderedSame)
+            return response.allHeaderFields[headerKey];
+    }
+
+    return nil;
+}
+
+- (NSError *)errorForResponse:(NSHTTPURLResponse *)response {
+    NSInteger statusCode = [response statusCode];
+
+    return [NSError errorWithDomain:NSStringFromClass([self class]) code:statusCode userInfo:@{@"statusCode": @(statusCode), @"response": response}];
+}
+
+#pragma mark - Chunks
+
+- (NSUInteger)chunkCount {
+    return (NSUInteger)((self.fileLength + self.chunkSize - 1) / self.chunkSize);
+}
+
+- (int64_t)offsetOfChunkAtIndex:(NSUInteger)index {
+    return (int64_t)index * self.chunkSize;
+}
+
+- (int64_t)lengthOfChunkAtIndex:(NSUInteger)index {
+    return MIN(self.chunkSize, self.fileLength - [self offsetOfChunkAtIndex:index]);
+}
+
+/* The offset from which a chunk is sent: its start, unless the server already has the first part of it.
+ */
+- (int64_t)unsentOffsetOfChunkAtIndex:(NSUInteger)index {
+    return MAX([self offsetOfChunkAtIndex:index], self.serverOffset);
+}
+
+#pragma mark - Saved progress
+
+- (NSURL *)savedProgressURL {
+    NSFileManager *fileManager = [NSFileManager defaultManager];
+    NSURL *applicationSupportURL = [[fileManager URLsForDirectory:NSApplicationSupportDirectory inDomains:NSUserDomainMask] firstObject];
+    NSURL *directoryURL = [applicationSupportURL URLByAppendingPathComponent:@"NetworkResumableUploads" isDirectory:YES];
+
+    [fileManager createDirectoryAtURL:directoryURL withIntermediateDirectories:YES attributes:nil error:nil];
+
+    // key the saved progress by the creation URL and the file, so that a new operation for the same upload finds it
+
+    NSString *key = [NSString stringWithFormat:@"%@\n%@", [self.request.URL absoluteString], [self.fileURL path]];
+    NSData *keyData = [key dataUsingEncoding:NSUTF8StringEncoding];
+    unsigned char digest[CC_SHA1_DIGEST_LENGTH];
+    CC_SHA1([keyData bytes], (CC_LONG)[keyData length], digest);
+
+    NSMutableString *filename = [NSMutableString stringWithCapacity:CC_SHA1_DIGEST_LENGTH * 2];
+    for (NSInteger i = 0; i < CC_SHA1_DIGEST_LENGTH; i++) {
+        [filename appendFormat:@"%02x", digest[i]];
+    }
+
+    return [directoryURL URLByAppendingPathComponent:[filename stringByAppendingPathExtension:@"plist"]];
+}
+
+- (void)loadSavedProgress {
+    NSDictionary *savedProgress = [NSDictionary dictionaryWithContentsOfURL:[self savedProgressURL]];
+
+    if (!savedProgress)
+        return;
+
+    // if the file or chunking has changed since, the saved progress is meaningless
+
+    if ([savedProgress[@"fileLength"] longLongValue] != self.fileLength ||
+        [savedProgress[@"chunkSize"] longLongValue] != self.chunkSize ||
+        fabs([savedProgress[@"fileModificationDate"] doubleValue] - [self.fileModificationDate timeIntervalSinceReferenceDate]) > 0.001 ||
+        !savedProgress[@"uploadURL"]) {
+        [self discardSavedProgress];
+        return;
+    }
+
+    self.uploadURL = [NSURL URLWithString:savedProgress[@"uploadURL"]];
+
+    for (NSNumber *index in savedProgress[@"acknowledgedChunks"]) {
+        [self.acknowledgedChunks addIndex:[index unsignedIntegerValue]];
+    }
+}
+
+- (void)saveProgress {
+    NSMutableArray *acknowledgedChunks = [NSMutableArray arrayWithCapacity:[self.acknowledgedChunks count]];
+    [self.acknowledgedChunks enumerateIndexesUsingBlock:^(NSUInteger index, BOOL *stop) {
+        [acknowledgedChunks addObject:@(index)];
+    }];
+
+    NSDictionary *savedProgress = @{@"uploadURL"            : [self.uploadURL absoluteString],
+                                    @"fileLength"           : @(self.fileLength),
+                                    @"fileModificationDate" : @([self.fileModificationDate timeIntervalSinceReferenceDate]),
+                                    @"chunkSize"            : @(self.chunkSize),
+                                    @"acknowledgedChunks"   : acknowledgedChunks};
+
+    [savedProgress writeToURL:[self savedProgressURL] atomically:YES];
+}
+
+- (void)discardSavedProgress {
+    [[NSFileManager defaultManager] removeItemAtURL:[self savedProgressURL] error:nil];
+}
+
+@end
@@ -8,6 +8,9 @@
 //  http://creativecommons.org/licenses/by-sa/4.0/
 
 #import <Foundation/Foundation.h>
+#import "NetworkTracer.h"
+#import "NetworkMemoryMonitor.h"
+#import "NetworkCircuitBreaker.h"
 
 @class NetworkTaskOperation;
 
@@ -114,6 +117,55 @@ typedef void(^WillPerformHTTPRedirectionHandler)(NetworkTaskOperation *operation
  */
 @property (nonatomic, strong) dispatch_queue_t completionQueue;
 
+/** An application-defined tag describing what this operation is for (e.g. `@"thumbnail"` or `@"backup"`).
+ *
+ * For background sessions, this is persisted with the task, so it is available on operations restored after a relaunch.
+ */
+@property (nonatomic, copy) NSString *purpose;
+
+/** The key of the handler binder (see `<NetworkManager>` method `registerHandlerBinder:forKey:`) that attaches this operation's handlers.
+ *
+ * For background sessions, this is persisted with the task, so that after a relaunch the handlers can be reattached
+ * to the restored operation when its first event arrives.
+ */
+@property (nonatomic, copy) NSString *handlerKey;
+
+/** Whether this is bulk (i.e. deferrable) work, such as prefetching or syncing, rather than something the user is waiting for. Default is `NO`.
+ *
+ * When memory is low, the `memoryMonitor` pauses bulk operations, and then rejects new ones.
+ */
+@property (nonatomic, getter = isBulk) BOOL bulk;
+
+/** The monitor to which this operation reports the memory it holds. If `nil` (the default), nothing is reported.
+ *
+ * This is set by the `<NetworkManager>` factory methods from the manager's `memoryMonitor`.
+ */
+@property (nonatomic, strong) NetworkMemoryMonitor *memoryMonitor;
+
+/** The circuit breaker that admitted this operation's task. If `nil` (the default), there is none.
+ *
+ * This is set by `<NetworkManager>` method `addOperation:`. When the operation finishes, it frees the task's probe
+ * slot (if it was admitted as a probe and the session never reported its completion, e.g. because it was canceled
+ * before it started).
+ */
+@property (nonatomic, strong) NetworkCircuitBreaker *circuitBreaker;
+
+/** The tracer to which this operation's lifecycle events are recorded. If `nil` (the default), nothing is recorded.
+ *
+ * This is set by the `<NetworkManager>` factory methods from the manager's `tracer`.
+ */
+@property (nonatomic, strong) NetworkTracer *tracer;
+
+/** The time, from `NetworkTracerNow()`, at which the operation was added to the queue. Set by `<NetworkManager>` method `addOperation:` when tracing.
+ */
+@property (nonatomic) uint64_t traceEnqueueTime;
+
+/** The error supplied to `<cancelWithError:>`, if any.
+ *
+ * When set, this is reported to the completion handler in lieu of the `NSURLErrorCancelled` error with which the task finishes.
+ */
+@property (nonatomic, strong, readonly) NSError *cancellationError;
+
 
 /// --------------------
 /// @name Initialization
@@ -151,4 +203,23 @@ typedef void(^WillPerformHTTPRedirectionHandler)(NetworkTaskOperation *operation
 
 - (void)completeOperation;
 
+/** Call a handler block synchronously on the `completionQueue`.
+ *
+ * This is used by the subclasses for all of their handler blocks. If there is a `tracer`, it records how long the
+ * calling thread waited for the `completionQueue` and how long the block ran.
+ *
+ * @param name  The name of the handler, for the trace. This must be a string literal.
+ * @param bytes The byte count to be included in the trace, or -1 if none.
+ * @param block The block that calls the handler.
+ */
+
+- (void)performHandlerNamed:(const char *)name bytes:(int64_t)bytes block:(dispatch_block_t)block;
+
+/** Cancel the operation, reporting the supplied error to the completion handler.
+ *
+ * @param error The error to be reported instead of `NSURLErrorCancelled`.
+ */
+
+- (void)cancelWithError:(NSError *)error;
+
 @end
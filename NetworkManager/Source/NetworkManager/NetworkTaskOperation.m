@@ -15,6 +15,8 @@
 
 @property (nonatomic, readwrite, getter = isFinished)  BOOL finished;
 @property (nonatomic, readwrite, getter = isExecuting) BOOL executing;
+@property (nonatomic, strong, readwrite) NSError *cancellationError;
+@property (nonatomic) uint64_t traceStartTime;
 
 @end
 
@@ -36,13 +38,23 @@
 
 - (void)start {
     if ([self isCancelled]) {
+        [self.memoryMonitor operationDidFinish:self];
+        [self.circuitBreaker releaseProbeSlotOfTask:self.task];
         self.finished = YES;
         return;
     }
 
+    if (self.tracer) {
+        self.traceStartTime = NetworkTracerNow();
+        if (self.traceEnqueueTime)
+            [self.tracer recordSpanNamed:"queued" category:"queue" start:self.traceEnqueueTime end:self.traceStartTime task:self.task bytes:-1];
+    }
+
     self.executing = YES;
 
     [self.task resume];
+
+    [self.memoryMonitor operationDidStart:self];
 }
 
 - (void)cancel {
@@ -50,7 +62,40 @@
     [super cancel];
 }
 
+- (void)cancelWithError:(NSError *)error {
+    self.cancellationError = error;
+    [self cancel];
+}
+
+- (void)performHandlerNamed:(const char *)name bytes:(int64_t)bytes block:(dispatch_block_t)block {
+    dispatch_queue_t queue = self.completionQueue ?: dispatch_get_main_queue();
+    NetworkTracer *tracer = self.tracer;
+
+    if (!tracer) {
+        dispatch_sync(queue, block);
+        return;
+    }
+
+    NSURLSessionTask *task = self.task;
+    uint64_t requested = NetworkTracerNow();
+    uint64_t __block began;
+
+    dispatch_sync(queue, ^{
+        began = NetworkTracerNow();
+        block();
+        [tracer recordSpanNamed:name category:"callback" start:began end:NetworkTracerNow() task:task bytes:bytes];
+    });
+
+    [tracer recordSpanNamed:name category:"dispatch_sync" start:requested end:began task:task bytes:bytes];
+}
+
 - (void)completeOperation {
+    if (self.tracer && self.traceStartTime)
+        [self.tracer recordSpanNamed:"task" category:"network" start:self.traceStartTime end:NetworkTracerNow() task:self.task bytes:self.task.countOfBytesReceived];
+
+    [self.memoryMonitor operationDidFinish:self];
+    [self.circuitBreaker releaseProbeSlotOfTask:self.task];
+
     self.executing = NO;
     self.finished = YES;
 }
@@ -81,10 +126,10 @@
 
 - (void)URLSession:(NSURLSession *)session task:(NSURLSessionTask *)task didCompleteWithError:(NSError *)error {
     if (self.didCompleteWithDataErrorHandler) {
-        dispatch_sync(self.completionQueue ?: dispatch_get_main_queue(), ^{
+        [self performHandlerNamed:"didComplete" bytes:-1 block:^{
             self.didCompleteWithDataErrorHandler(self, nil, error);
             self.didCompleteWithDataErrorHandler = nil;
-        });
+        }];
     }
 
     [self completeOperation];
@@ -92,9 +137,9 @@
 
 - (void)URLSession:(NSURLSession *)session task:(NSURLSessionTask *)task didReceiveChallenge:(NSURLAuthenticationChallenge *)challenge completionHandler:(void (^)(NSURLSessionAuthChallengeDisposition disposition, NSURLCredential *credential))completionHandler {
     if (self.didReceiveChallengeHandler) {
-        dispatch_sync(self.completionQueue ?: dispatch_get_main_queue(), ^{
+        [self performHandlerNamed:"didReceiveChallenge" bytes:-1 block:^{
             self.didReceiveChallengeHandler(self, challenge, completionHandler);
-        });
+        }];
     } else {
         if (challenge.previousFailureCount == 0 && self.credential) {
             completionHandler(NSURLSessionAuthChallengeUseCredential, self.credential);
@@ -106,17 +151,17 @@
 
 - (void)URLSession:(NSURLSession *)session task:(NSURLSessionTask *)task didSendBodyData:(int64_t)bytesSent totalBytesSent:(int64_t)totalBytesSent totalBytesExpectedToSend:(int64_t)totalBytesExpectedToSend {
     if (self.didSendBodyDataHandler) {
-        dispatch_sync(self.completionQueue ?: dispatch_get_main_queue(), ^{
+        [self performHandlerNamed:"didSendBodyData" bytes:totalBytesSent block:^{
             self.didSendBodyDataHandler(self, bytesSent, totalBytesSent, totalBytesExpectedToSend);
-        });
+        }];
     }
 }
 
 - (void)URLSession:(NSURLSession *)session task:(NSURLSessionTask *)task needNewBodyStream:(void (^)(NSInputStream *bodyStream))completionHandler {
     if (self.needNewBodyStreamHandler) {
-        dispatch_sync(self.completionQueue ?: dispatch_get_main_queue(), ^{
+        [self performHandlerNamed:"needNewBodyStream" bytes:-1 block:^{
             self.needNewBodyStreamHandler(self, completionHandler);
-        });
+        }];
     } else {
         completionHandler(nil);
     }
@@ -124,9 +169,9 @@
 
 - (void)URLSession:(NSURLSession *)session task:(NSURLSessionTask *)task willPerformHTTPRedirection:(NSHTTPURLResponse *)response newRequest:(NSURLRequest *)request completionHandler:(void (^)(NSURLRequest *))completionHandler {
     if (self.willPerformHTTPRedirectionHandler) {
-        dispatch_sync(self.completionQueue ?: dispatch_get_main_queue(), ^{
+        [self performHandlerNamed:"willPerformHTTPRedirection" bytes:-1 block:^{
             self.willPerformHTTPRedirectionHandler(self, response, request, completionHandler);
-        });
+        }];
     } else {
         completionHandler(request);
     }
@@ -0,0 +1,122 @@
+//
+//  NetworkTracer.h
+//
+//  Created by agent on 10/19/26.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+//  This work is licensed under a Creative Commons Attribution-ShareAlike 4.0 International License.
+//  http://creativecommons.org/licenses/by-sa/4.0/
+
+#import <Foundation/Foundation.h>
+
+/** Returns the current time, in `mach_absolute_time` units, for use with `<NetworkTracer>`.
+ */
+extern uint64_t NetworkTracerNow(void);
+
+/** Records the lifecycle of network operations for viewing in a trace viewer.
+
+ When assigned to the `tracer` property of a `<NetworkManager>`, the manager and its operations record:
+
+ - `queued`: the time an operation waited in the `networkQueue`;
+ - `task`: the time from the start of the operation until its completion;
+ - `response`: the receipt of the response;
+ - a span for each handler (e.g. `didReceiveData`, `progress`, `didWriteData`, `didComplete`), measuring how long it ran on the completion queue;
+ - a `dispatch_sync` span for each handler, measuring how long the session's delegate queue was blocked waiting for the completion queue.
+ - `challenge` (or `challenge (cached)`): the time from receipt of an authentication challenge until it was answered.
+ - `accumulateData`: for a data task without a `didReceiveData` handler, the time spent appending each chunk of data to the response (or spilling it to disk) on the session's delegate queue.
+
+ Every event carries the task identifier, the host, and a byte count where applicable.
+
+ Events are written, without locks, to a fixed-size ring buffer (so only the most recent `<capacity>` events are kept),
+ and can be exported in Chrome trace-event JSON format, e.g. to be loaded into `chrome://tracing` or Perfetto.
+
+ If the manager has no tracer (the default), none of this is done.
+ */
+
+@interface NetworkTracer : NSObject
+
+/// ----------------
+/// @name Properties
+/// ----------------
+
+/// The number of events the ring buffer holds.
+
+@property (nonatomic, readonly) NSUInteger capacity;
+
+/// --------------------
+/// @name Initialization
+/// --------------------
+
+/** Create tracer.
+ *
+ * @param capacity The number of events the ring buffer holds.
+ *
+ * @return         Returns `NetworkTracer`.
+ */
+
+- (instancetype)initWithCapacity:(NSUInteger)capacity;
+
+/// ------------------
+/// @name Recording
+/// ------------------
+
+/** Record span.
+ *
+ * @param name     The name of the span. This must be a string literal (or otherwise outlive the tracer).
+ * @param category The category of the span. This must be a string literal (or otherwise outlive the tracer).
+ * @param start    The start time, from `NetworkTracerNow()`.
+ * @param end      The end time, from `NetworkTracerNow()`.
+ * @param task     The task to which the span relates, if any.
+ * @param bytes    The byte count associated with the span, or -1 if none.
+ */
+
+- (void)recordSpanNamed:(const char *)name
+               category:(const char *)category
+                  start:(uint64_t)start
+                    end:(uint64_t)end
+                   task:(NSURLSessionTask *)task
+                  bytes:(int64_t)bytes;
+
+/** Record instantaneous event.
+ *
+ * @param name     The name of the event. This must be a string literal (or otherwise outlive the tracer).
+ * @param category The category of the event. This must be a string literal (or otherwise outlive the tracer).
+ * @param task     The task to which the event relates, if any.
+ * @param bytes    The byte count associated with the event, or -1 if none.
+ */
+
+- (void)recordInstantNamed:(const char *)name
+                  category:(const char *)category
+                      task:(NSURLSessionTask *)task
+                     bytes:(int64_t)bytes;
+
+/// ------------------
+/// @name Export
+/// ------------------
+
+/** The recorded events in Chrome trace-event JSON format.
+ *
+ * @return `NSData` of the JSON.
+ */
+
+- (NSData *)chromeTraceData;
+
+/** Write the recorded events in Chrome trace-event JSON format.
+ *
+ * @param url   The file URL to which the trace should be written.
+ * @param error If the file could not be written, this will be set to the error.
+ *
+ * @return `YES` if the trace was written.
+ */
+
+- (BOOL)writeChromeTraceToURL:(NSURL *)url error:(NSError **)error;
+
+/** Discard all recorded events.
+ *
+ * This may be called while events are being recorded: the ring buffer isn't cleared, but rather the events recorded
+ * before the reset are excluded from later exports.
+ */
+
+- (void)reset;
+
+@end
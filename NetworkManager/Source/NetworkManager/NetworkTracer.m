@@ -0,0 +1,208 @@
+//
+//  NetworkTracer.m
+//
+//  Created by agent on 10/19/26.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+//  This work is licensed under a Creative Commons Attribution-ShareAlike 4.0 International License.
+//  http://creativecommons.org/licenses/by-sa/4.0/
+
+#import "NetworkTracer.h"
+#import <mach/mach_time.h>
+#import <pthread.h>
+#import <stdatomic.h>
+
+#define kNetworkTracerHostLength 64
+
+/* A single event.
+ */
+typedef struct {
+    const char *name;
+    const char *category;
+    char        phase;
+    uint64_t    start;
+    uint64_t    end;
+    NSUInteger  taskIdentifier;
+    BOOL        hasTask;
+    int64_t     bytes;
+    uint32_t    threadIdentifier;
+    char        host[kNetworkTracerHostLength];
+} NetworkTraceEvent;
+
+/* A slot in the ring buffer.
+ *
+ * `sequence` is zero while the event is being written, and the event's (one-based) sequence number once it
+ * has been, which is how readers detect (and skip) events that are being overwritten as they read them.
+ */
+typedef struct {
+    _Atomic int64_t   sequence;
+    NetworkTraceEvent event;
+} NetworkTraceSlot;
+
+uint64_t NetworkTracerNow(void) {
+    return mach_absolute_time();
+}
+
+@interface NetworkTracer () {
+    NetworkTraceSlot *_slots;
+    _Atomic int64_t   _lastSequence;
+    _Atomic int64_t   _firstSequence;   // the first sequence number since the last `reset`
+}
+
+@property (nonatomic, readwrite) NSUInteger capacity;
+
+@end
+
+@implementation NetworkTracer
+
+- (instancetype)init {
+    return [self initWithCapacity:16384];
+}
+
+- (instancetype)initWithCapacity:(NSUInteger)capacity {
+    NSParameterAssert(capacity > 0);
+
+    self = [super init];
+    if (self) {
+        _capacity = capacity;
+        _slots = calloc(capacity, sizeof(NetworkTraceSlot));
+        if (!_slots)
+            return nil;
+        atomic_init(&_lastSequence, 0);
+        atomic_init(&_firstSequence, 1);
+    }
+    return self;
+}
+
+- (void)dealloc {
+    free(_slots);
+}
+
+#pragma mark - Recording
+
+- (void)recordSpanNamed:(const char *)name
+               category:(const char *)category
+                  start:(uint64_t)start
+                    end:(uint64_t)end
+                   task:(NSURLSessionTask *)task
+                  bytes:(int64_t)bytes {
+    [self recordEventWithPhase:'X' name:name category:category start:start end:end task:task bytes:bytes];
+}
+
+- (void)recordInstantNamed:(const char *)name
+                  category:(const char *)category
+                      task:(NSURLSessionTask *)task
+                     bytes:(int64_t)bytes {
+    uint64_t now = NetworkTracerNow();
+
+    [self recordEventWithPhase:'i' name:name category:category start:now end:now task:task bytes:bytes];
+}
+
+- (void)recordEventWithPhase:(char)phase
+                        name:(const char *)name
+                    category:(const char *)category
+                       start:(uint64_t)start
+                         end:(uint64_t)end
+                        task:(NSURLSessionTask *)task
+                       bytes:(int64_t)bytes {
+    // claim a slot; this is the only point of contention between writers
+
+    int64_t sequence = atomic_fetch_add_explicit(&_lastSequence, 1, memory_order_relaxed) + 1;
+    NetworkTraceSlot *slot = &_slots[(sequence - 1) % _capacity];
+    NetworkTraceEvent *event = &slot->event;
+
+    // mark the slot as being written before touching the event (a seqlock, in effect)
+
+    atomic_store_explicit(&slot->sequence, 0, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+
+    event->name             = name;
+    event->category         = category;
+    event->phase            = phase;
+    event->start            = start;
+    event->end              = end;
+    event->hasTask          = task != nil;
+    event->taskIdentifier   = task.taskIdentifier;
+    event->bytes            = bytes;
+    event->threadIdentifier = pthread_mach_thread_np(pthread_self());
+    event->host[0]          = '\0';
+
+    NSString *host = task.originalRequest.URL.host;
+    if (host && ![host getCString:event->host maxLength:kNetworkTracerHostLength encoding:NSUTF8StringEncoding])
+        event->host[0] = '\0';
+
+    atomic_store_explicit(&slot->sequence, sequence, memory_order_release);
+}
+
+#pragma mark - Export
+
+- (NSArray *)traceEvents {
+    static mach_timebase_info_data_t timebase;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        mach_timebase_info(&timebase);
+    });
+
+    NSMutableArray *traceEvents = [NSMutableArray array];
+    int processIdentifier = [[NSProcessInfo processInfo] processIdentifier];
+
+    int64_t lastSequence = atomic_load_explicit(&_lastSequence, memory_order_acquire);
+    int64_t firstSequence = MAX(atomic_load_explicit(&_firstSequence, memory_order_acquire), lastSequence - (int64_t)_capacity + 1);
+
+    for (int64_t sequence = firstSequence; sequence <= lastSequence; sequence++) {
+        NetworkTraceSlot *slot = &_slots[(sequence - 1) % _capacity];
+
+        // copy the event, and only use the copy if it wasn't being written while we copied it
+
+        int64_t sequenceBefore = atomic_load_explicit(&slot->sequence, memory_order_acquire);
+        NetworkTraceEvent event = slot->event;
+        atomic_thread_fence(memory_order_acquire);
+        if (sequenceBefore != sequence || atomic_load_explicit(&slot->sequence, memory_order_relaxed) != sequence)
+            continue;
+
+        double timestamp = (double)event.start * timebase.numer / timebase.denom / NSEC_PER_USEC;
+
+        NSMutableDictionary *args = [NSMutableDictionary dictionary];
+        if (event.hasTask)
+            args[@"task"] = @(event.taskIdentifier);
+        if (event.host[0])
+            args[@"host"] = @(event.host);
+        if (event.bytes >= 0)
+            args[@"bytes"] = @(event.bytes);
+
+        NSMutableDictionary *traceEvent = [@{@"name" : @(event.name),
+                                             @"cat"  : @(event.category),
+                                             @"ph"   : [NSString stringWithFormat:@"%c", event.phase],
+                                             @"ts"   : @(timestamp),
+                                             @"pid"  : @(processIdentifier),
+                                             @"tid"  : @(event.threadIdentifier),
+                                             @"args" : args} mutableCopy];
+
+        if (event.phase == 'X') {
+            traceEvent[@"dur"] = @((double)(event.end - event.start) * timebase.numer / timebase.denom / NSEC_PER_USEC);
+        } else {
+            traceEvent[@"s"] = @"t";
+        }
+
+        [traceEvents addObject:traceEvent];
+    }
+
+    return traceEvents;
+}
+
+- (NSData *)chromeTraceData {
+    return [NSJSONSerialization dataWithJSONObject:@{@"traceEvents": [self traceEvents], @"displayTimeUnit": @"ms"} options:0 error:nil];
+}
+
+- (BOOL)writeChromeTraceToURL:(NSURL *)url error:(NSError **)error {
+    return [[self chromeTraceData] writeToURL:url options:NSDataWritingAtomic error:error];
+}
+
+- (void)reset {
+    // rather than clearing slots that writers may be filling, just ignore everything recorded so far
+
+    int64_t lastSequence = atomic_load_explicit(&_lastSequence, memory_order_acquire);
+    atomic_store_explicit(&_firstSequence, lastSequence + 1, memory_order_release);
+}
+
+@end
@@ -17,6 +17,14 @@
  */
 @interface NetworkUploadTaskOperation : NetworkDataTaskOperation
 
+/// ----------------
+/// @name Properties
+/// ----------------
+
+/// The length of the in-memory body supplied with `data`, or zero if the body is uploaded from a file.
+
+@property (nonatomic, readonly) int64_t bodyLength;
+
 /// --------------------
 /// @name Initialization
 /// --------------------
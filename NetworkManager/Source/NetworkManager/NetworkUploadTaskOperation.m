@@ -9,6 +9,12 @@
 
 #import "NetworkUploadTaskOperation.h"
 
+@interface NetworkUploadTaskOperation ()
+
+@property (nonatomic, readwrite) int64_t bodyLength;
+
+@end
+
 @implementation NetworkUploadTaskOperation
 
 - (instancetype)initWithSession:(NSURLSession *)session
@@ -17,6 +23,7 @@
     self = [super init];
     if (self) {
         self.task = [session uploadTaskWithRequest:request fromData:data];
+        self.bodyLength = [data length];
     }
     return self;
 }
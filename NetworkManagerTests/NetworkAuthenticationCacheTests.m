@@ -0,0 +1,312 @@
+//
+//  NetworkAuthenticationCacheTests.m
+//  NetworkManagerTests
+//
+//  Created by agent on 10/19/26.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+
+#import <XCTest/XCTest.h>
+#import "NetworkManager.h"
+
+@import Security;
+
+// two self-signed certificates for `trust.test` (valid until 2126), as base64 DER
+
+static NSString * const kCertificateA =
+    @"MIIDDTCCAfWgAwIBAgIUcctDS0KOkHWEjYMo9i4pGDWnBDgwDQYJKoZIhvcNAQELBQAwFTETMBEGA1UEAwwKdHJ1c3QudGVzdDAg"
+    @"Fw0yNjEwMTkwMjIxMzlaGA8yMTI2MDkyNTAyMjEzOVowFTETMBEGA1UEAwwKdHJ1c3QudGVzdDCCASIwDQYJKoZIhvcNAQEBBQAD"
+    @"ggEPADCCAQoCggEBAMHtmeNyK0B/Je8fK1U4XaiEZea5sLvGwi3wrs/C6JoxrDjgPfGK9ag9rWytbX9/5YSkwSJNObr4X/owfVb1"
+    @"DDT4SnV75L3GTZSCnTboi/4InS6iRmnAN+SEiFtfAmfo5FJOxd/Sm5wX3fXEMIg6X/PZTnsf4FfX+BjlLkSVQeP61JJP5WAl0iih"
+    @"EzUrPN6KU02uqxP/xm4mNhbHg6aeWpxAlv5ZViHOnpcalbuXTIWtkvNPE1/Xo8czNaK94RgP6yHHynW+lJFJNq1HSX7APElIQzSZ"
+    @"mJXgq1WKDoCSb94JRhV0R0cK5jFN995zVw97dB57EWrGMTcvpLCV4gCkFycCAwEAAaNTMFEwHQYDVR0OBBYEFDbDBhJAnqOOZMp9"
+    @"ubfke/y45IbTMB8GA1UdIwQYMBaAFDbDBhJAnqOOZMp9ubfke/y45IbTMA8GA1UdEwEB/wQFMAMBAf8wDQYJKoZIhvcNAQELBQAD"
+    @"ggEBAGCOSwwuXgeRuAfM6gLrG8pTOgeWAfSgcE444zeWl1lzPR8SldgpP9qLXla0dGQ40Yia1nDfqjAbH1FMFlR5QAxFDxJsxgAB"
+    @"36DSWl4mvtpCRl5XoPc6Y7vS0ix5mdkkp3oZwcxi/GZ0YrP8c/rMORoV+lzUopAjQrcKsnXWKl16OiT3u6CWkUPfjboI1eikVcMv"
+    @"SCQoNoMnLMCz0QG9pLLzZgMievzjoYbJCcJBnCSXg/0fzduqmEiHFHSASP2svJEsG8pFcNqJLYQKb1OQZwzD+WOmIiWxfLCsMG/F"
+    @"pALOGvauwD4rdcF74HkCC0PhVMfjinc+mhfLketqrV9VsUI=";
+
+static NSString * const kCertificateB =
+    @"MIIDDTCCAfWgAwIBAgIUDtPlpApnZo9J5t4v+yNRp8XqQ0UwDQYJKoZIhvcNAQELBQAwFTETMBEGA1UEAwwKdHJ1c3QudGVzdDAg"
+    @"Fw0yNjEwMTkwMjIxMzlaGA8yMTI2MDkyNTAyMjEzOVowFTETMBEGA1UEAwwKdHJ1c3QudGVzdDCCASIwDQYJKoZIhvcNAQEBBQAD"
+    @"ggEPADCCAQoCggEBAOOt6XfOQNyxImhadxo/04V2982nATcWtvSDMYhLH2azqSLnddst4MQDkph5GVxy29QtXBXkTvcqVVDES9UU"
+    @"qYtWfVRnLjrnbl/FRImVraGGMnYm0HyfljweJgp0jbtqL7PEWk3QkMwz+ND5D82sPfl+CGdbIIvSQN2pvSOo+yfX1YvxiebW8d0n"
+    @"dai/GtsmZhaoCcZQ2w4lIybPex5+neD9CvOSvP5zSwPb5Y5SOAWTbXf77vKu58PNRFLNh/vFmCsgLrIcXYQe1b2n8XsP+iTSWlsB"
+    @"tDi78boQZTPu2btvfCmNWTd/BQTgKB41r/sxysZ46kuat/+qIKnI1uFLvEECAwEAAaNTMFEwHQYDVR0OBBYEFNoz9KlJf77Xbmf4"
+    @"+9ZHVlnK7WI4MB8GA1UdIwQYMBaAFNoz9KlJf77Xbmf4+9ZHVlnK7WI4MA8GA1UdEwEB/wQFMAMBAf8wDQYJKoZIhvcNAQELBQAD"
+    @"ggEBAErF53nxrqKVz85TwGOLrZ/7T43ViTTCXwzIZXb4ZiGILeY4iXQwPi/cYLn2JkbTgxputSwoJ98bjlKbAaiDo+MlUq0RfN7N"
+    @"BVvyiYwxi9RydQj6jVIxu6NJSO4m1SwCMdLjD2scRNwjB7Opo9dUpl/W4FwmL2jSMxPHhXTBqP8YZc10NvtYjwWvnChdquHLemop"
+    @"ZNqjnLdpWq5K4cHz/D3Z2oxb4n+sGVgHiULRZrzDV31hr5loxsA/3XCGIicAAc5gvkexsX9U14o2DFVY/oVcg4MJB550QyB183XX"
+    @"eXBxZvxEb344qfDnIMiL2db2QeBgfLZwu5A2M8M5sHQ86CM=";
+
+/* A protection space with a server trust, which `NSURLProtectionSpace` won't otherwise let us create.
+ */
+@interface NetworkTestProtectionSpace : NSURLProtectionSpace
+@property (nonatomic) SecTrustRef testServerTrust;
+@end
+
+@implementation NetworkTestProtectionSpace
+
+- (void)dealloc {
+    if (_testServerTrust)
+        CFRelease(_testServerTrust);
+}
+
+- (void)setTestServerTrust:(SecTrustRef)testServerTrust {
+    if (testServerTrust)
+        CFRetain(testServerTrust);
+    if (_testServerTrust)
+        CFRelease(_testServerTrust);
+    _testServerTrust = testServerTrust;
+}
+
+- (SecTrustRef)serverTrust {
+    return self.testServerTrust;
+}
+
+@end
+
+
+@interface NetworkTestChallengeSender : NSObject <NSURLAuthenticationChallengeSender>
+@end
+
+@implementation NetworkTestChallengeSender
+- (void)useCredential:(NSURLCredential *)credential forAuthenticationChallenge:(NSURLAuthenticationChallenge *)challenge {}
+- (void)continueWithoutCredentialForAuthenticationChallenge:(NSURLAuthenticationChallenge *)challenge {}
+- (void)cancelAuthenticationChallenge:(NSURLAuthenticationChallenge *)challenge {}
+@end
+
+
+/* The session delegate methods, which `NetworkManager` implements but doesn't declare.
+ */
+@interface NetworkManager (SessionDelegate) <NSURLSessionTaskDelegate>
+@end
+
+
+@interface NetworkAuthenticationCacheTests : XCTestCase
+
+@property (nonatomic, strong) NetworkAuthenticationCache *cache;
+@property (nonatomic, strong) NetworkTestChallengeSender *sender;
+@property (atomic) NSUInteger handlerCallCount;
+
+@end
+
+@implementation NetworkAuthenticationCacheTests
+
+- (void)setUp {
+    [super setUp];
+
+    self.cache = [[NetworkAuthenticationCache alloc] init];
+    self.sender = [[NetworkTestChallengeSender alloc] init];
+}
+
+#pragma mark - Helpers
+
+/* A trust for the certificate, which passes the system's evaluation only if `anchored`.
+ */
+- (SecTrustRef)copyTrustWithCertificate:(NSString *)base64 anchored:(BOOL)anchored {
+    NSData *data = [[NSData alloc] initWithBase64EncodedString:base64 options:0];
+    SecCertificateRef certificate = SecCertificateCreateWithData(NULL, (__bridge CFDataRef)data);
+    SecPolicyRef policy = SecPolicyCreateBasicX509();
+    SecTrustRef trust = NULL;
+
+    XCTAssertEqual(SecTrustCreateWithCertificates(certificate, policy, &trust), errSecSuccess);
+    if (anchored) {
+        SecTrustSetAnchorCertificates(trust, (__bridge CFArrayRef)@[(__bridge id)certificate]);
+        SecTrustSetAnchorCertificatesOnly(trust, YES);
+    }
+
+    CFRelease(policy);
+    CFRelease(certificate);
+
+    return trust;
+}
+
+- (NSURLAuthenticationChallenge *)serverTrustChallengeWithCertificate:(NSString *)base64 anchored:(BOOL)anchored {
+    NetworkTestProtectionSpace *protectionSpace = [[NetworkTestProtectionSpace alloc] initWithHost:@"trust.test" port:443 protocol:NSURLProtectionSpaceHTTPS realm:nil authenticationMethod:NSURLAuthenticationMethodServerTrust];
+    SecTrustRef trust = [self copyTrustWithCertificate:base64 anchored:anchored];
+    protectionSpace.testServerTrust = trust;
+    CFRelease(trust);
+
+    return [[NSURLAuthenticationChallenge alloc] initWithProtectionSpace:protectionSpace proposedCredential:nil previousFailureCount:0 failureResponse:nil error:nil sender:self.sender];
+}
+
+- (NSURLAuthenticationChallenge *)basicChallengeWithPreviousFailureCount:(NSInteger)previousFailureCount {
+    NSURLProtectionSpace *protectionSpace = [[NSURLProtectionSpace alloc] initWithHost:@"basic.test" port:443 protocol:NSURLProtectionSpaceHTTPS realm:@"realm" authenticationMethod:NSURLAuthenticationMethodHTTPBasic];
+
+    return [[NSURLAuthenticationChallenge alloc] initWithProtectionSpace:protectionSpace proposedCredential:nil previousFailureCount:previousFailureCount failureResponse:nil error:nil sender:self.sender];
+}
+
+- (NSURLCredential *)userCredential {
+    return [NSURLCredential credentialWithUser:@"user" password:@"password" persistence:NSURLCredentialPersistenceForSession];
+}
+
+- (BOOL)lookUpChallenge:(NSURLAuthenticationChallenge *)challenge credential:(NSURLCredential **)credential {
+    NSURLSessionAuthChallengeDisposition disposition;
+
+    return [self.cache getDisposition:&disposition credential:credential forChallenge:challenge];
+}
+
+#pragma mark - Credentials
+
+- (void)testCredentialDecisionIsCached {
+    XCTAssertFalse([self lookUpChallenge:[self basicChallengeWithPreviousFailureCount:0] credential:nil]);
+
+    [self.cache storeDisposition:NSURLSessionAuthChallengeUseCredential credential:[self userCredential] forChallenge:[self basicChallengeWithPreviousFailureCount:0]];
+
+    NSURLCredential *credential;
+    XCTAssertTrue([self lookUpChallenge:[self basicChallengeWithPreviousFailureCount:0] credential:&credential]);
+    XCTAssertEqualObjects(credential.user, @"user");
+    XCTAssertEqual(self.cache.hitCount, 1u);
+    XCTAssertEqual(self.cache.missCount, 1u);
+}
+
+- (void)testFailedChallengeDiscardsDecision {
+    [self.cache storeDisposition:NSURLSessionAuthChallengeUseCredential credential:[self userCredential] forChallenge:[self basicChallengeWithPreviousFailureCount:0]];
+
+    XCTAssertFalse([self lookUpChallenge:[self basicChallengeWithPreviousFailureCount:1] credential:nil]);
+    XCTAssertFalse([self lookUpChallenge:[self basicChallengeWithPreviousFailureCount:0] credential:nil]);
+}
+
+- (void)testDecisionExpires {
+    self.cache.credentialLifetime = 0.1;
+    [self.cache storeDisposition:NSURLSessionAuthChallengeUseCredential credential:[self userCredential] forChallenge:[self basicChallengeWithPreviousFailureCount:0]];
+
+    [NSThread sleepForTimeInterval:0.2];
+
+    XCTAssertFalse([self lookUpChallenge:[self basicChallengeWithPreviousFailureCount:0] credential:nil]);
+}
+
+- (void)testCancelIsNotCached {
+    [self.cache storeDisposition:NSURLSessionAuthChallengeCancelAuthenticationChallenge credential:nil forChallenge:[self basicChallengeWithPreviousFailureCount:0]];
+
+    XCTAssertFalse([self lookUpChallenge:[self basicChallengeWithPreviousFailureCount:0] credential:nil]);
+}
+
+- (void)testRemoveDecisionsForHost {
+    [self.cache storeDisposition:NSURLSessionAuthChallengeUseCredential credential:[self userCredential] forChallenge:[self basicChallengeWithPreviousFailureCount:0]];
+
+    [self.cache removeDecisionsForHost:@"BASIC.test"];
+
+    XCTAssertFalse([self lookUpChallenge:[self basicChallengeWithPreviousFailureCount:0] credential:nil]);
+}
+
+#pragma mark - Server trust
+
+- (void)testServerTrustDecisionIsUsedForTrustThatPassesEvaluation {
+    NSURLAuthenticationChallenge *challenge = [self serverTrustChallengeWithCertificate:kCertificateA anchored:YES];
+    [self.cache storeDisposition:NSURLSessionAuthChallengeUseCredential credential:[NSURLCredential credentialForTrust:challenge.protectionSpace.serverTrust] forChallenge:challenge];
+
+    // the credential is created for the new challenge's own trust, not the one that was cached
+
+    NSURLAuthenticationChallenge *nextChallenge = [self serverTrustChallengeWithCertificate:kCertificateA anchored:YES];
+    NSURLCredential *credential;
+    XCTAssertTrue([self lookUpChallenge:nextChallenge credential:&credential]);
+    XCTAssertNotNil(credential);
+}
+
+- (void)testCustomTrustDecisionIsReused {
+    // the certificate is self-signed, so the system doesn't trust it, but the handler's own policy accepted it
+
+    NSURLAuthenticationChallenge *challenge = [self serverTrustChallengeWithCertificate:kCertificateA anchored:NO];
+    [self.cache storeDisposition:NSURLSessionAuthChallengeUseCredential credential:[NSURLCredential credentialForTrust:challenge.protectionSpace.serverTrust] forChallenge:challenge];
+
+    NSURLCredential *credential;
+    XCTAssertTrue([self lookUpChallenge:[self serverTrustChallengeWithCertificate:kCertificateA anchored:NO] credential:&credential]);
+    XCTAssertNotNil(credential);
+    XCTAssertEqual(self.cache.hitCount, 1u);
+}
+
+- (void)testCustomTrustDecisionIsReusedByManager {
+    NetworkManager *manager = [[NetworkManager alloc] init];
+    manager.authenticationCache = self.cache;
+
+    __weak typeof(self) weakSelf = self;
+    manager.didReceiveChallenge = ^(NetworkManager *manager, NSURLAuthenticationChallenge *challenge, void (^completionHandler)(NSURLSessionAuthChallengeDisposition disposition, NSURLCredential *credential)) {
+        weakSelf.handlerCallCount++;
+        completionHandler(NSURLSessionAuthChallengeUseCredential, [NSURLCredential credentialForTrust:challenge.protectionSpace.serverTrust]);
+    };
+
+    XCTestExpectation *expectation = [self expectationWithDescription:@"answered"];
+
+    dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+        for (NSUInteger i = 0; i < 3; i++) {
+            [manager URLSession:nil task:nil didReceiveChallenge:[self serverTrustChallengeWithCertificate:kCertificateA anchored:NO] completionHandler:^(NSURLSessionAuthChallengeDisposition disposition, NSURLCredential *credential) {
+                XCTAssertEqual(disposition, NSURLSessionAuthChallengeUseCredential);
+                XCTAssertNotNil(credential);
+            }];
+        }
+        [expectation fulfill];
+    });
+
+    [self waitForExpectationsWithTimeout:10 handler:nil];
+
+    XCTAssertEqual(self.handlerCallCount, 1u);
+}
+
+- (void)testServerTrustDecisionIsPerCertificate {
+    NSURLAuthenticationChallenge *challenge = [self serverTrustChallengeWithCertificate:kCertificateA anchored:YES];
+    [self.cache storeDisposition:NSURLSessionAuthChallengeUseCredential credential:[NSURLCredential credentialForTrust:challenge.protectionSpace.serverTrust] forChallenge:challenge];
+
+    XCTAssertFalse([self lookUpChallenge:[self serverTrustChallengeWithCertificate:kCertificateB anchored:YES] credential:nil]);
+}
+
+#pragma mark - Connection setup
+
+/* Answer `count` challenges the way the session would, on a background queue, with a handler that, like any
+ * manager-level handler, runs on the main queue.
+ */
+- (void)answerChallengesWithCount:(NSUInteger)count manager:(NetworkManager *)manager {
+    XCTestExpectation *expectation = [self expectationWithDescription:@"answered"];
+    NSURLAuthenticationChallenge *challenge = [self basicChallengeWithPreviousFailureCount:0];
+
+    dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+        for (NSUInteger i = 0; i < count; i++) {
+            [manager URLSession:nil task:nil didReceiveChallenge:challenge completionHandler:^(NSURLSessionAuthChallengeDisposition disposition, NSURLCredential *credential) {
+                XCTAssertEqual(disposition, NSURLSessionAuthChallengeUseCredential);
+            }];
+        }
+        [expectation fulfill];
+    });
+
+    [self waitForExpectationsWithTimeout:30 handler:nil];
+}
+
+- (NetworkManager *)managerCountingHandlerCalls {
+    NetworkManager *manager = [[NetworkManager alloc] init];
+    NSURLCredential *credential = [self userCredential];
+
+    __weak typeof(self) weakSelf = self;
+    manager.didReceiveChallenge = ^(NetworkManager *manager, NSURLAuthenticationChallenge *challenge, void (^completionHandler)(NSURLSessionAuthChallengeDisposition disposition, NSURLCredential *credential)) {
+        weakSelf.handlerCallCount++;
+        completionHandler(NSURLSessionAuthChallengeUseCredential, credential);
+    };
+
+    return manager;
+}
+
+// compare these two to see what the cache saves in connection setup
+
+- (void)testPerformanceChallengesWithoutCache {
+    NetworkManager *manager = [self managerCountingHandlerCalls];
+
+    [self measureBlock:^{
+        [self answerChallengesWithCount:200 manager:manager];
+    }];
+
+    XCTAssertGreaterThan(self.handlerCallCount, 0u);
+    XCTAssertEqual(self.handlerCallCount % 200, 0u, @"every challenge should have needed the handler");
+}
+
+- (void)testPerformanceChallengesWithCache {
+    NetworkManager *manager = [self managerCountingHandlerCalls];
+    manager.authenticationCache = self.cache;
+
+    [self measureBlock:^{
+        [self answerChallengesWithCount:200 manager:manager];
+    }];
+
+    XCTAssertEqual(self.handlerCallCount, 1u, @"only the first challenge should have needed the handler");
+}
+
+@end
@@ -0,0 +1,225 @@
+//
+//  NetworkBackgroundRestorationTests.m
+//  NetworkManagerTests
+//
+//  Created by agent on 10/19/26.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+
+#import <XCTest/XCTest.h>
+#import "NetworkManager.h"
+#import "NetworkStubURLProtocol.h"
+
+@interface NetworkBackgroundRestorationTests : XCTestCase
+
+@property (nonatomic, copy) NSString *identifier;
+
+@end
+
+@implementation NetworkBackgroundRestorationTests
+
+- (void)setUp {
+    [super setUp];
+
+    // a new identifier each time, so the session has no tasks of its own from an earlier run
+
+    self.identifier = [NSString stringWithFormat:@"NetworkBackgroundRestorationTests.%@", [[NSUUID UUID] UUIDString]];
+}
+
+- (void)tearDown {
+    [[NSFileManager defaultManager] removeItemAtURL:[self recordsURL] error:nil];
+    [NetworkStubURLProtocol reset];
+
+    [super tearDown];
+}
+
+#pragma mark - Helpers
+
+/* Where `NetworkManager` keeps the records of its background tasks.
+ */
+- (NSURL *)recordsURL {
+    NSURL *applicationSupportURL = [[[NSFileManager defaultManager] URLsForDirectory:NSApplicationSupportDirectory inDomains:NSUserDomainMask] firstObject];
+    NSURL *folderURL = [applicationSupportURL URLByAppendingPathComponent:@"NetworkBackgroundTasks"];
+
+    [[NSFileManager defaultManager] createDirectoryAtURL:folderURL withIntermediateDirectories:YES attributes:nil error:nil];
+
+    return [folderURL URLByAppendingPathComponent:[self.identifier stringByAppendingPathExtension:@"plist"]];
+}
+
+- (NSDictionary *)recordWithAge:(NSTimeInterval)age {
+    return @{@"class": NSStringFromClass([NetworkDownloadTaskOperation class]),
+             @"purpose": @"test",
+             @"handler": @"test",
+             @"date": @([NSDate timeIntervalSinceReferenceDate] - age)};
+}
+
+- (NetworkManager *)managerRestoringRecords:(NSDictionary *)records setupHandler:(void (^)(NetworkManager *manager))setupHandler {
+    XCTAssertTrue([records writeToURL:[self recordsURL] atomically:YES]);
+
+    NSURLSessionConfiguration *configuration = [NSURLSessionConfiguration backgroundSessionConfigurationWithIdentifier:self.identifier];
+    return [[NetworkManager alloc] initWithSessionConfiguration:configuration setupHandler:setupHandler];
+}
+
+/* A manager whose downloads are served `data` by the stub server.
+ */
+- (NetworkManager *)managerServingData:(NSData *)data {
+    [NetworkStubURLProtocol setResponseProvider:^NetworkStubResponse *(NSURLRequest *request, NSData *body) {
+        return [NetworkStubResponse responseWithStatusCode:200 headerFields:nil data:data];
+    }];
+
+    return [[NetworkManager alloc] initWithSessionConfiguration:[NetworkStubURLProtocol sessionConfiguration]];
+}
+
+#pragma mark - Tests
+
+- (void)testRestoresRecentRecordsOnly {
+    __block NSArray *operations;
+
+    // look before the session is created, so it can't yet have reported the recent record's task as gone
+
+    [self managerRestoringRecords:@{@"41": [self recordWithAge:60],
+                                    @"42": [self recordWithAge:30 * 24 * 60 * 60]} setupHandler:^(NetworkManager *manager) {
+        operations = [manager restoredOperations];
+    }];
+
+    XCTAssertEqual([operations count], 1u);
+    NetworkTaskOperation *operation = [operations firstObject];
+    XCTAssertEqualObjects(operation.purpose, @"test");
+    XCTAssertTrue([operation isKindOfClass:[NetworkDownloadTaskOperation class]]);
+}
+
+- (void)testOperationsForLostTasksAreCanceled {
+    __block NSArray *operations;
+    NetworkManager *manager = [self managerRestoringRecords:@{@"41": [self recordWithAge:60],
+                                                              @"42": [self recordWithAge:60]} setupHandler:^(NetworkManager *manager) {
+        operations = [manager restoredOperations];
+    }];
+
+    // the session has none of these tasks, so once it says so, each operation is canceled with an error
+
+    XCTAssertEqual([operations count], 2u);
+    for (NetworkTaskOperation *operation in operations) {
+        [self keyValueObservingExpectationForObject:operation keyPath:@"isFinished" expectedValue:@YES];
+    }
+
+    [self waitForExpectationsWithTimeout:10 handler:nil];
+
+    for (NetworkTaskOperation *operation in operations) {
+        XCTAssertTrue([operation isCancelled]);
+        XCTAssertEqualObjects(operation.cancellationError.domain, NSURLErrorDomain);
+        XCTAssertEqual(operation.cancellationError.code, NSURLErrorCancelled);
+    }
+    XCTAssertEqual([[manager restoredOperations] count], 0u);
+
+    // and their records are removed (the records are written asynchronously)
+
+    NSDictionary *records;
+    for (NSUInteger i = 0; i < 20; i++) {
+        [[NSRunLoop currentRunLoop] runUntilDate:[NSDate dateWithTimeIntervalSinceNow:0.1]];
+        records = [NSDictionary dictionaryWithContentsOfURL:[self recordsURL]];
+        if ([records count] == 0)
+            break;
+    }
+    XCTAssertEqual([records count], 0u);
+}
+
+- (void)testBoundHandlerIsToldOfLostTask {
+    XCTestExpectation *expectation = [self expectationWithDescription:@"told"];
+
+    // a download is told through its `didFinishDownloadingHandler`, bound before the session can report the task as gone
+
+    [self managerRestoringRecords:@{@"41": [self recordWithAge:60]} setupHandler:^(NetworkManager *manager) {
+        manager.didCompleteWithError = ^(NetworkManager *manager, NSURLSessionTask *task, NSError *error) {
+            XCTFail(@"bound operation reported to the manager");
+        };
+
+        [manager registerHandlerBinder:^(NetworkManager *manager, NetworkTaskOperation *operation) {
+            [(NetworkDownloadTaskOperation *)operation setDidFinishDownloadingHandler:^(NetworkDownloadTaskOperation *operation, NSURL *location, NSError *error) {
+                XCTAssertTrue([NSThread isMainThread]);
+                XCTAssertNil(location);
+                XCTAssertEqualObjects(error.domain, NSURLErrorDomain);
+                XCTAssertEqual(error.code, NSURLErrorCancelled);
+                [expectation fulfill];
+            }];
+        } forKey:@"test"];
+    }];
+
+    [self waitForExpectationsWithTimeout:10 handler:nil];
+}
+
+- (void)testUnboundLostTaskIsReportedToManager {
+    XCTestExpectation *expectation = [self expectationWithDescription:@"told"];
+
+    NetworkManager *manager = [self managerRestoringRecords:@{@"41": [self recordWithAge:60]} setupHandler:^(NetworkManager *manager) {
+        manager.didCompleteWithError = ^(NetworkManager *manager, NSURLSessionTask *task, NSError *error) {
+            XCTAssertNil(task);
+            XCTAssertEqualObjects(error.domain, NSURLErrorDomain);
+            XCTAssertEqual(error.code, NSURLErrorCancelled);
+            [expectation fulfill];
+        };
+    }];
+
+    [self waitForExpectationsWithTimeout:10 handler:nil];
+
+    XCTAssertEqual([[manager restoredOperations] count], 0u);
+}
+
+- (void)testDownloadWithoutHandlerIsReportedToManager {
+    NSData *data = [@"downloaded" dataUsingEncoding:NSUTF8StringEncoding];
+    NetworkManager *manager = [self managerServingData:data];
+    NSURL *destinationURL = [NSURL fileURLWithPath:[NSTemporaryDirectory() stringByAppendingPathComponent:[[NSUUID UUID] UUIDString]]];
+    XCTestExpectation *finished = [self expectationWithDescription:@"finished"];
+    XCTestExpectation *completed = [self expectationWithDescription:@"completed"];
+
+    // like a restored operation that hasn't been bound: a destination, but no handler
+
+    manager.didFinishDownloadingToURL = ^(NetworkManager *manager, NSURLSessionDownloadTask *downloadTask, NSURL *location) {
+        XCTAssertEqualObjects(location, destinationURL);
+        XCTAssertEqualObjects([NSData dataWithContentsOfURL:location], data);
+        [finished fulfill];
+    };
+    manager.didCompleteWithError = ^(NetworkManager *manager, NSURLSessionTask *task, NSError *error) {
+        XCTAssertNil(error);
+        [completed fulfill];
+    };
+
+    NetworkDownloadTaskOperation *operation = [manager downloadOperationWithURL:[NSURL URLWithString:@"http://download.test/file"] didWriteDataHandler:nil didFinishDownloadingHandler:nil];
+    operation.destinationURL = destinationURL;
+    [manager addOperation:operation];
+
+    [self waitForExpectationsWithTimeout:10 handler:nil];
+
+    [[NSFileManager defaultManager] removeItemAtURL:destinationURL error:nil];
+}
+
+- (void)testFailedMoveIsReportedToManager {
+    NSData *data = [@"downloaded" dataUsingEncoding:NSUTF8StringEncoding];
+    NetworkManager *manager = [self managerServingData:data];
+    NSString *missingFolder = [NSTemporaryDirectory() stringByAppendingPathComponent:[[NSUUID UUID] UUIDString]];
+    NSURL *destinationURL = [NSURL fileURLWithPath:[missingFolder stringByAppendingPathComponent:@"file"]];
+    XCTestExpectation *finished = [self expectationWithDescription:@"finished"];
+    XCTestExpectation *completed = [self expectationWithDescription:@"completed"];
+
+    // the destination's folder doesn't exist, so the file can't be moved there, and is left where the session put it
+
+    manager.didFinishDownloadingToURL = ^(NetworkManager *manager, NSURLSessionDownloadTask *downloadTask, NSURL *location) {
+        XCTAssertNotEqualObjects(location, destinationURL);
+        XCTAssertEqualObjects([NSData dataWithContentsOfURL:location], data);
+        [finished fulfill];
+    };
+    manager.didCompleteWithError = ^(NetworkManager *manager, NSURLSessionTask *task, NSError *error) {
+        XCTAssertNotNil(error);
+        [completed fulfill];
+    };
+
+    NetworkDownloadTaskOperation *operation = [manager downloadOperationWithURL:[NSURL URLWithString:@"http://download.test/file"] didWriteDataHandler:nil didFinishDownloadingHandler:nil];
+    operation.destinationURL = destinationURL;
+    [manager addOperation:operation];
+
+    [self waitForExpectationsWithTimeout:10 handler:nil];
+
+    XCTAssertNotNil(operation.moveError);
+    XCTAssertFalse([[NSFileManager defaultManager] fileExistsAtPath:[destinationURL path]]);
+}
+
+@end
@@ -0,0 +1,248 @@
+//
+//  NetworkCircuitBreakerTests.m
+//  NetworkManagerTests
+//
+//  Created by agent on 10/19/26.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+
+#import <XCTest/XCTest.h>
+#import "NetworkManager.h"
+#import "NetworkStubURLProtocol.h"
+
+static NSString * const kHost = @"breaker.test";
+
+@interface NetworkCircuitBreakerTests : XCTestCase
+
+@property (nonatomic, strong) NetworkManager *manager;
+@property (nonatomic, strong) NetworkCircuitBreaker *breaker;
+
+@end
+
+@implementation NetworkCircuitBreakerTests
+
+- (void)setUp {
+    [super setUp];
+
+    [NetworkStubURLProtocol reset];
+
+    // each request says, in its query, what status to return and how long to take, e.g. `?status=500&delay=0.2`
+
+    [NetworkStubURLProtocol setResponseProvider:^NetworkStubResponse *(NSURLRequest *request, NSData *body) {
+        NSURLComponents *components = [NSURLComponents componentsWithURL:request.URL resolvingAgainstBaseURL:NO];
+        NSInteger status = 200;
+        NSTimeInterval delay = 0;
+        for (NSURLQueryItem *item in components.queryItems) {
+            if ([item.name isEqualToString:@"status"])
+                status = [item.value integerValue];
+            else if ([item.name isEqualToString:@"delay"])
+                delay = [item.value doubleValue];
+        }
+
+        NetworkStubResponse *response = [NetworkStubResponse responseWithStatusCode:status headerFields:nil data:[NSData data]];
+        response.delay = delay;
+        return response;
+    }];
+
+    self.breaker = [[NetworkCircuitBreaker alloc] init];
+    self.breaker.consecutiveFailureThreshold = 2;
+    self.breaker.cooldown = 0.3;
+
+    self.manager = [[NetworkManager alloc] initWithSessionConfiguration:[NetworkStubURLProtocol sessionConfiguration]];
+    self.manager.circuitBreaker = self.breaker;
+}
+
+- (void)tearDown {
+    [[self.manager networkQueue] cancelAllOperations];
+    [NetworkStubURLProtocol reset];
+
+    [super tearDown];
+}
+
+- (NSURL *)URLWithStatus:(NSInteger)status delay:(NSTimeInterval)delay {
+    return [NSURL URLWithString:[NSString stringWithFormat:@"http://%@/?status=%ld&delay=%.2f&nonce=%@", kHost, (long)status, delay, [[NSUUID UUID] UUIDString]]];
+}
+
+- (NetworkDataTaskOperation *)addRequestWithStatus:(NSInteger)status delay:(NSTimeInterval)delay expectation:(XCTestExpectation *)expectation errors:(NSMutableArray *)errors {
+    NetworkDataTaskOperation *operation = [self.manager dataOperationWithURL:[self URLWithStatus:status delay:delay] progressHandler:nil completionHandler:^(NetworkTaskOperation *operation, NSData *data, NSError *error) {
+        if (error)
+            [errors addObject:error];
+        [expectation fulfill];
+    }];
+    [self.manager addOperation:operation];
+    return operation;
+}
+
+- (void)performRequestWithStatus:(NSInteger)status {
+    [self addRequestWithStatus:status delay:0 expectation:[self expectationWithDescription:@"complete"] errors:nil];
+    [self waitForExpectationsWithTimeout:5 handler:nil];
+}
+
+- (void)openCircuit {
+    for (NSUInteger i = 0; i < self.breaker.consecutiveFailureThreshold; i++) {
+        [self performRequestWithStatus:500];
+    }
+    XCTAssertEqual([self.breaker stateForHost:kHost], NetworkCircuitBreakerStateOpen);
+}
+
+- (void)waitForCooldown {
+    [[NSRunLoop currentRunLoop] runUntilDate:[NSDate dateWithTimeIntervalSinceNow:self.breaker.cooldown + 0.1]];
+    XCTAssertEqual([self.breaker stateForHost:kHost], NetworkCircuitBreakerStateHalfOpen);
+}
+
+#pragma mark - Tests
+
+- (void)testConsecutiveFailuresOpenCircuit {
+    [self performRequestWithStatus:500];
+    XCTAssertEqual([self.breaker stateForHost:kHost], NetworkCircuitBreakerStateClosed);
+
+    [self performRequestWithStatus:500];
+    XCTAssertEqual([self.breaker stateForHost:kHost], NetworkCircuitBreakerStateOpen);
+}
+
+- (void)testSuccessResetsConsecutiveFailures {
+    [self performRequestWithStatus:500];
+    [self performRequestWithStatus:200];
+    [self performRequestWithStatus:500];
+
+    XCTAssertEqual([self.breaker stateForHost:kHost], NetworkCircuitBreakerStateClosed);
+}
+
+- (void)testOpenCircuitFailsFast {
+    [self openCircuit];
+    NSUInteger requestCount = [NetworkStubURLProtocol requestCount];
+
+    NSMutableArray *errors = [NSMutableArray array];
+    [self addRequestWithStatus:200 delay:0 expectation:[self expectationWithDescription:@"complete"] errors:errors];
+    [self waitForExpectationsWithTimeout:5 handler:nil];
+
+    XCTAssertEqual([errors count], 1u);
+    XCTAssertEqualObjects([[errors firstObject] domain], kNetworkCircuitBreakerErrorDomain);
+    XCTAssertEqual([NetworkStubURLProtocol requestCount], requestCount, @"the request should never have reached the server");
+}
+
+- (void)testSuccessfulProbeClosesCircuit {
+    [self openCircuit];
+    [self waitForCooldown];
+
+    [self performRequestWithStatus:200];
+
+    XCTAssertEqual([self.breaker stateForHost:kHost], NetworkCircuitBreakerStateClosed);
+}
+
+- (void)testFailedProbeReopensCircuit {
+    [self openCircuit];
+    [self waitForCooldown];
+
+    [self performRequestWithStatus:500];
+
+    XCTAssertEqual([self.breaker stateForHost:kHost], NetworkCircuitBreakerStateOpen);
+}
+
+- (void)testRejectedRequestsDoNotFreeProbeSlot {
+    [self openCircuit];
+    [self waitForCooldown];
+    NSUInteger requestCount = [NetworkStubURLProtocol requestCount];
+
+    // the probe is slow; everything submitted while it is in flight must be rejected, even after the
+    // (canceled) completions of the earlier rejections have been reported to the breaker
+
+    NSMutableArray *errors = [NSMutableArray array];
+    [self addRequestWithStatus:200 delay:1.0 expectation:[self expectationWithDescription:@"probe"] errors:errors];
+
+    for (NSUInteger i = 0; i < 5; i++) {
+        [self addRequestWithStatus:200 delay:0 expectation:[self expectationWithDescription:@"rejected"] errors:errors];
+        [[NSRunLoop currentRunLoop] runUntilDate:[NSDate dateWithTimeIntervalSinceNow:0.05]];
+    }
+
+    [self waitForExpectationsWithTimeout:5 handler:nil];
+
+    XCTAssertEqual([NetworkStubURLProtocol requestCount], requestCount + 1, @"only the probe should have reached the server");
+    XCTAssertEqual([errors count], 5u);
+    for (NSError *error in errors) {
+        XCTAssertEqualObjects(error.domain, kNetworkCircuitBreakerErrorDomain);
+    }
+    XCTAssertEqual([self.breaker stateForHost:kHost], NetworkCircuitBreakerStateClosed);
+}
+
+- (void)testProbeCanceledBeforeStartingFreesSlot {
+    [self openCircuit];
+    [self waitForCooldown];
+
+    // the probe is admitted, but canceled while it waits in the queue, so its task never runs
+
+    [[self.manager networkQueue] setSuspended:YES];
+    NetworkDataTaskOperation *probe = [self addRequestWithStatus:200 delay:0 expectation:nil errors:nil];
+    [probe cancel];
+    [self keyValueObservingExpectationForObject:probe keyPath:@"isFinished" expectedValue:@YES];
+    [[self.manager networkQueue] setSuspended:NO];
+    [self waitForExpectationsWithTimeout:5 handler:nil];
+
+    XCTAssertEqual([self.breaker stateForHost:kHost], NetworkCircuitBreakerStateHalfOpen);
+
+    // so the next request is admitted as the probe, and closes the circuit
+
+    NSMutableArray *errors = [NSMutableArray array];
+    [self addRequestWithStatus:200 delay:0 expectation:[self expectationWithDescription:@"probe"] errors:errors];
+    [self waitForExpectationsWithTimeout:5 handler:nil];
+
+    XCTAssertEqual([errors count], 0u);
+    XCTAssertEqual([self.breaker stateForHost:kHost], NetworkCircuitBreakerStateClosed);
+}
+
+- (void)testReleasingProbeSlotDoesNotCountAsOutcome {
+    [self openCircuit];
+    [self waitForCooldown];
+
+    NSURLSession *session = [NSURLSession sessionWithConfiguration:[NetworkStubURLProtocol sessionConfiguration]];
+    NSURLSessionTask *probe = [session dataTaskWithURL:[self URLWithStatus:200 delay:0]];
+    NSURLSessionTask *other = [session dataTaskWithURL:[self URLWithStatus:200 delay:0]];
+
+    XCTAssertTrue([self.breaker shouldAllowTask:probe error:nil]);
+    XCTAssertFalse([self.breaker shouldAllowTask:other error:nil]);
+
+    [self.breaker releaseProbeSlotOfTask:probe];
+    XCTAssertEqual([self.breaker stateForHost:kHost], NetworkCircuitBreakerStateHalfOpen);
+    XCTAssertTrue([self.breaker shouldAllowTask:other error:nil]);
+
+    // releasing a task that isn't a probe changes nothing
+
+    [self.breaker releaseProbeSlotOfTask:probe];
+    XCTAssertFalse([self.breaker shouldAllowTask:probe error:nil]);
+
+    [session invalidateAndCancel];
+}
+
+- (void)testStragglersDoNotCountAsProbes {
+    // two fast failures open the circuit while two slow failures are still in flight
+
+    NSMutableArray *errors = [NSMutableArray array];
+    [self addRequestWithStatus:500 delay:0.05 expectation:[self expectationWithDescription:@"fast"] errors:errors];
+    [self addRequestWithStatus:500 delay:0.1 expectation:[self expectationWithDescription:@"fast"] errors:errors];
+    [self addRequestWithStatus:500 delay:0.7 expectation:[self expectationWithDescription:@"straggler"] errors:errors];
+    [self addRequestWithStatus:500 delay:0.8 expectation:[self expectationWithDescription:@"straggler"] errors:errors];
+
+    [[NSRunLoop currentRunLoop] runUntilDate:[NSDate dateWithTimeIntervalSinceNow:0.2]];
+    XCTAssertEqual([self.breaker stateForHost:kHost], NetworkCircuitBreakerStateOpen);
+
+    // once half-open, a slow successful probe outlasts the stragglers, whose failures must not reopen the circuit
+
+    [self waitForCooldown];
+    [self addRequestWithStatus:200 delay:0.6 expectation:[self expectationWithDescription:@"probe"] errors:nil];
+
+    [self waitForExpectationsWithTimeout:5 handler:nil];
+
+    XCTAssertEqual([self.breaker stateForHost:kHost], NetworkCircuitBreakerStateClosed);
+}
+
+- (void)testHostsAreIndependent {
+    [self openCircuit];
+
+    XCTAssertEqual([self.breaker stateForHost:@"other.test"], NetworkCircuitBreakerStateClosed);
+    XCTAssertEqualObjects([self.breaker hostStates], @{kHost: @(NetworkCircuitBreakerStateOpen)});
+
+    [self.breaker reset];
+    XCTAssertEqual([self.breaker stateForHost:kHost], NetworkCircuitBreakerStateClosed);
+}
+
+@end
@@ -0,0 +1,206 @@
+//
+//  NetworkHedgingTests.m
+//  NetworkManagerTests
+//
+//  Created by agent on 10/19/26.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+
+#import <XCTest/XCTest.h>
+#import "NetworkManager.h"
+#import "NetworkStubURLProtocol.h"
+
+@interface NetworkHedgingTests : XCTestCase
+
+@property (nonatomic, strong) NetworkManager *manager;
+
+@end
+
+@implementation NetworkHedgingTests
+
+- (void)setUp {
+    [super setUp];
+
+    [NetworkStubURLProtocol reset];
+    self.manager = [[NetworkManager alloc] initWithSessionConfiguration:[NetworkStubURLProtocol sessionConfiguration]];
+}
+
+- (void)tearDown {
+    [[self.manager networkQueue] cancelAllOperations];
+    [NetworkStubURLProtocol reset];
+
+    [super tearDown];
+}
+
+/* The first request for each URL takes `delay` seconds; any later request for it is answered immediately.
+ */
+- (void)stubFirstAttemptDelay:(NSTimeInterval)delay {
+    NSMutableDictionary *attempts = [NSMutableDictionary dictionary];
+
+    [NetworkStubURLProtocol setResponseProvider:^NetworkStubResponse *(NSURLRequest *request, NSData *body) {
+        NSString *key = [request.URL absoluteString];
+        NSUInteger attempt = [attempts[key] unsignedIntegerValue];
+        attempts[key] = @(attempt + 1);
+
+        NetworkStubResponse *response = [NetworkStubResponse responseWithStatusCode:200 headerFields:nil data:[[NSString stringWithFormat:@"attempt %lu", (unsigned long)attempt] dataUsingEncoding:NSUTF8StringEncoding]];
+        response.delay = attempt == 0 ? delay : 0;
+        return response;
+    }];
+}
+
+- (NSTimeInterval)timeRequestWithURL:(NSURL *)url hedgeDelay:(NSTimeInterval)hedgeDelay data:(NSData **)data {
+    XCTestExpectation *expectation = [self expectationWithDescription:@"complete"];
+    __block NSData *responseData;
+    CFAbsoluteTime start = CFAbsoluteTimeGetCurrent();
+
+    DidCompleteWithDataErrorHandler completion = ^(NetworkTaskOperation *operation, NSData *data, NSError *error) {
+        XCTAssertNil(error);
+        responseData = data;
+        [expectation fulfill];
+    };
+
+    NetworkDataTaskOperation *operation;
+    if (hedgeDelay > 0)
+        operation = [self.manager dataOperationWithRequest:[NSURLRequest requestWithURL:url] hedgeDelay:hedgeDelay progressHandler:nil completionHandler:completion];
+    else
+        operation = [self.manager dataOperationWithURL:url progressHandler:nil completionHandler:completion];
+
+    [self.manager addOperation:operation];
+    [self waitForExpectationsWithTimeout:10 handler:nil];
+
+    if (data)
+        *data = responseData;
+
+    return CFAbsoluteTimeGetCurrent() - start;
+}
+
+- (NSTimeInterval)percentile:(double)percentile ofSamples:(NSArray *)samples {
+    NSArray *sorted = [samples sortedArrayUsingSelector:@selector(compare:)];
+    NSUInteger index = MIN([sorted count] - 1, (NSUInteger)ceil(percentile * [sorted count]) - 1);
+
+    return [sorted[index] doubleValue];
+}
+
+#pragma mark - Tests
+
+- (void)testHedgeReducesTailLatency {
+    // one request in ten is slow the first time it is asked for, so without hedging, the slow ones are the tail
+
+    NSUInteger count = 40;
+    NSMutableDictionary *attempts = [NSMutableDictionary dictionary];
+
+    [NetworkStubURLProtocol setResponseProvider:^NetworkStubResponse *(NSURLRequest *request, NSData *body) {
+        NSString *key = [request.URL absoluteString];
+        NSUInteger attempt = [attempts[key] unsignedIntegerValue];
+        attempts[key] = @(attempt + 1);
+
+        NetworkStubResponse *response = [NetworkStubResponse responseWithStatusCode:200 headerFields:nil data:[key dataUsingEncoding:NSUTF8StringEncoding]];
+        response.delay = (attempt == 0 && [[request.URL lastPathComponent] integerValue] % 10 == 9) ? 0.5 : 0;
+        return response;
+    }];
+    self.manager.hedgeBudget = 1.0;
+
+    NSMutableArray *unhedged = [NSMutableArray array];
+    NSMutableArray *hedged = [NSMutableArray array];
+
+    for (NSUInteger i = 0; i < count; i++) {
+        NSString *path = [NSString stringWithFormat:@"/%lu", (unsigned long)i];
+        [unhedged addObject:@([self timeRequestWithURL:[NSURL URLWithString:[@"http://stub.test/unhedged" stringByAppendingString:path]] hedgeDelay:0 data:NULL])];
+        [hedged addObject:@([self timeRequestWithURL:[NSURL URLWithString:[@"http://stub.test/hedged" stringByAppendingString:path]] hedgeDelay:0.1 data:NULL])];
+    }
+
+    XCTAssertGreaterThanOrEqual([self percentile:0.95 ofSamples:unhedged], 0.5);
+    XCTAssertGreaterThanOrEqual([self percentile:0.99 ofSamples:unhedged], 0.5);
+    XCTAssertLessThan([self percentile:0.95 ofSamples:hedged], 0.4);
+    XCTAssertLessThan([self percentile:0.99 ofSamples:hedged], 0.4);
+}
+
+- (void)testFirstHedgedRequestMayHedgeWithinDefaultBudget {
+    [self stubFirstAttemptDelay:1.0];
+
+    NSData *data;
+    [self timeRequestWithURL:[NSURL URLWithString:@"http://stub.test/first"] hedgeDelay:0.1 data:&data];
+
+    XCTAssertEqualObjects(data, [@"attempt 1" dataUsingEncoding:NSUTF8StringEncoding]);
+    XCTAssertEqual([NetworkStubURLProtocol requestCount], 2u);
+}
+
+- (void)testBudgetLimitsHedges {
+    [self stubFirstAttemptDelay:0.3];
+
+    // with the default budget of 0.1, only the first of these may hedge
+
+    XCTestExpectation *expectation = [self expectationWithDescription:@"complete"];
+    NSUInteger count = 5;
+    __block NSUInteger completed = 0;
+
+    for (NSUInteger i = 0; i < count; i++) {
+        NSURL *url = [NSURL URLWithString:[NSString stringWithFormat:@"http://stub.test/budget/%lu", (unsigned long)i]];
+        NetworkDataTaskOperation *operation = [self.manager dataOperationWithRequest:[NSURLRequest requestWithURL:url] hedgeDelay:0.05 progressHandler:nil completionHandler:^(NetworkTaskOperation *operation, NSData *data, NSError *error) {
+            XCTAssertNil(error);
+            if (++completed == count)
+                [expectation fulfill];
+        }];
+        [self.manager addOperation:operation];
+    }
+
+    [self waitForExpectationsWithTimeout:10 handler:nil];
+
+    XCTAssertEqual([NetworkStubURLProtocol requestCount], count + 1);
+}
+
+- (void)testOperationsNeverAddedDoNotCountTowardsBudget {
+    [self stubFirstAttemptDelay:0.3];
+
+    for (NSUInteger i = 0; i < 20; i++) {
+        NSURL *url = [NSURL URLWithString:[NSString stringWithFormat:@"http://stub.test/abandoned/%lu", (unsigned long)i]];
+        [self.manager dataOperationWithRequest:[NSURLRequest requestWithURL:url] hedgeDelay:0.05 progressHandler:nil completionHandler:nil];
+    }
+
+    // with the default budget of 0.1, the first added request may hedge, but the second may not
+
+    NSData *data;
+    [self timeRequestWithURL:[NSURL URLWithString:@"http://stub.test/added/0"] hedgeDelay:0.05 data:&data];
+    XCTAssertEqualObjects(data, [@"attempt 1" dataUsingEncoding:NSUTF8StringEncoding]);
+
+    [self timeRequestWithURL:[NSURL URLWithString:@"http://stub.test/added/1"] hedgeDelay:0.05 data:&data];
+    XCTAssertEqualObjects(data, [@"attempt 0" dataUsingEncoding:NSUTF8StringEncoding]);
+
+    XCTAssertEqual([NetworkStubURLProtocol requestCount], 3u);
+}
+
+- (void)testNonIdempotentRequestIsNotHedged {
+    NSMutableURLRequest *request = [NSMutableURLRequest requestWithURL:[NSURL URLWithString:@"http://stub.test/post"]];
+    request.HTTPMethod = @"POST";
+
+    NetworkDataTaskOperation *operation = [self.manager dataOperationWithRequest:request hedgeDelay:0.1 progressHandler:nil completionHandler:nil];
+
+    XCTAssertEqual(operation.hedgeDelay, 0.0);
+    XCTAssertNil(operation.hedgeTaskProvider);
+}
+
+- (void)testConcurrentHedgesAllComplete {
+    [self stubFirstAttemptDelay:0.2];
+    self.manager.hedgeBudget = 1.0;
+
+    // the hedge tasks are registered from the hedge timer while the delegate queue is busy with the other requests
+
+    XCTestExpectation *expectation = [self expectationWithDescription:@"complete"];
+    NSUInteger count = 50;
+    __block NSUInteger completed = 0;
+
+    for (NSUInteger i = 0; i < count; i++) {
+        NSURL *url = [NSURL URLWithString:[NSString stringWithFormat:@"http://stub.test/concurrent/%lu", (unsigned long)i]];
+        NetworkDataTaskOperation *operation = [self.manager dataOperationWithRequest:[NSURLRequest requestWithURL:url] hedgeDelay:0.01 progressHandler:nil completionHandler:^(NetworkTaskOperation *operation, NSData *data, NSError *error) {
+            XCTAssertNil(error);
+            XCTAssertNotNil(data);
+            if (++completed == count)
+                [expectation fulfill];
+        }];
+        [self.manager addOperation:operation];
+    }
+
+    [self waitForExpectationsWithTimeout:20 handler:nil];
+}
+
+@end
@@ -0,0 +1,311 @@
+//
+//  NetworkImageProcessorTests.m
+//  NetworkManagerTests
+//
+//  Created by agent on 10/19/26.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+
+#import <XCTest/XCTest.h>
+#import "NetworkManager+Image.h"
+#import "NetworkStubURLProtocol.h"
+
+@import ImageIO;
+@import MobileCoreServices;
+
+@interface NetworkImageProcessorTests : XCTestCase
+
+@property (nonatomic, strong) NetworkImageProcessor *processor;
+
+@end
+
+@implementation NetworkImageProcessorTests
+
+- (void)setUp {
+    [super setUp];
+
+    self.processor = [[NetworkImageProcessor alloc] initWithImageScale:1.0];
+}
+
+- (void)tearDown {
+    [NetworkStubURLProtocol reset];
+
+    [super tearDown];
+}
+
+#pragma mark - Helpers
+
+- (UIImage *)imageWithPixelSize:(CGSize)size {
+    UIGraphicsBeginImageContextWithOptions(size, YES, 1.0);
+    for (CGFloat y = 0; y < size.height; y += 8) {
+        [[UIColor colorWithHue:y / size.height saturation:1.0 brightness:1.0 alpha:1.0] setFill];
+        UIRectFill(CGRectMake(0, y, size.width, 8));
+    }
+    UIImage *image = UIGraphicsGetImageFromCurrentImageContext();
+    UIGraphicsEndImageContext();
+
+    return image;
+}
+
+- (NSData *)PNGDataWithPixelSize:(CGSize)size {
+    return UIImagePNGRepresentation([self imageWithPixelSize:size]);
+}
+
+- (NSData *)progressiveJPEGDataWithPixelSize:(CGSize)size {
+    NSMutableData *data = [NSMutableData data];
+    CGImageDestinationRef destination = CGImageDestinationCreateWithData((__bridge CFMutableDataRef)data, kUTTypeJPEG, 1, NULL);
+    NSDictionary *properties = @{(__bridge NSString *)kCGImageDestinationLossyCompressionQuality: @0.8,
+                                 (__bridge NSString *)kCGImagePropertyJFIFDictionary: @{(__bridge NSString *)kCGImagePropertyJFIFIsProgressive: @YES}};
+    CGImageDestinationAddImage(destination, [self imageWithPixelSize:size].CGImage, (__bridge CFDictionaryRef)properties);
+    CGImageDestinationFinalize(destination);
+    CFRelease(destination);
+
+    return data;
+}
+
+- (UIImage *)processData:(NSData *)data url:(NSURL *)url maximumPixelSize:(CGFloat)maximumPixelSize error:(NSError **)error {
+    XCTestExpectation *expectation = [self expectationWithDescription:@"decoded"];
+    __block UIImage *result;
+    __block NSError *resultError;
+
+    [self.processor processImageData:data forURL:url maximumPixelSize:maximumPixelSize queue:nil completionHandler:^(UIImage *image, NSError *error) {
+        XCTAssertTrue([NSThread isMainThread]);
+        result = image;
+        resultError = error;
+        [expectation fulfill];
+    }];
+
+    [self waitForExpectationsWithTimeout:10 handler:nil];
+
+    if (error)
+        *error = resultError;
+
+    return result;
+}
+
+#pragma mark - Tests
+
+- (void)testDownsamplesToMaximumPixelSize {
+    UIImage *image = [self processData:[self PNGDataWithPixelSize:CGSizeMake(1000, 500)] url:[NSURL URLWithString:@"http://image.test/a.png"] maximumPixelSize:100 error:nil];
+
+    XCTAssertNotNil(image);
+    XCTAssertEqual(CGImageGetWidth(image.CGImage), 100u);
+    XCTAssertEqual(CGImageGetHeight(image.CGImage), 50u);
+}
+
+- (void)testImageScale {
+    self.processor = [[NetworkImageProcessor alloc] initWithImageScale:3.0];
+
+    UIImage *image = [self processData:[self PNGDataWithPixelSize:CGSizeMake(300, 300)] url:nil maximumPixelSize:300 error:nil];
+
+    XCTAssertEqual(image.scale, 3.0);
+    XCTAssertEqual(image.size.width, 100.0);
+}
+
+- (void)testDefaultScaleIsReadOffTheMainThread {
+    XCTestExpectation *expectation = [self expectationWithDescription:@"created"];
+    __block NetworkImageProcessor *processor;
+
+    dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+        processor = [[NetworkImageProcessor alloc] init];
+        [expectation fulfill];
+    });
+
+    [self waitForExpectationsWithTimeout:5 handler:nil];
+
+    XCTAssertEqual(processor.imageScale, [[UIScreen mainScreen] scale]);
+}
+
+- (void)testCreatingOffTheMainThreadDoesNotWaitForIt {
+    dispatch_semaphore_t semaphore = dispatch_semaphore_create(0);
+    __block NetworkImageProcessor *processor;
+
+    // block the main thread on a thread that creates a processor, which would deadlock if it waited for the main thread
+
+    dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+        processor = [[NetworkImageProcessor alloc] init];
+        dispatch_semaphore_signal(semaphore);
+    });
+
+    XCTAssertEqual(dispatch_semaphore_wait(semaphore, dispatch_time(DISPATCH_TIME_NOW, (int64_t)(5 * NSEC_PER_SEC))), 0);
+    XCTAssertEqual(processor.imageScale, [[UIScreen mainScreen] scale]);
+}
+
+- (void)testUndecodableDataFails {
+    NSError *error;
+    UIImage *image = [self processData:[@"not an image" dataUsingEncoding:NSUTF8StringEncoding] url:nil maximumPixelSize:100 error:&error];
+
+    XCTAssertNil(image);
+    XCTAssertEqualObjects(error.domain, NSURLErrorDomain);
+    XCTAssertEqual(error.code, NSURLErrorCannotDecodeContentData);
+}
+
+- (void)testDecodedImageIsCachedBySize {
+    NSURL *url = [NSURL URLWithString:@"http://image.test/cached.png"];
+
+    [self processData:[self PNGDataWithPixelSize:CGSizeMake(400, 400)] url:url maximumPixelSize:100 error:nil];
+
+    XCTAssertNotNil([self.processor cachedImageForURL:url maximumPixelSize:100]);
+    XCTAssertNil([self.processor cachedImageForURL:url maximumPixelSize:200]);
+
+    [self.processor removeAllCachedImages];
+    XCTAssertNil([self.processor cachedImageForURL:url maximumPixelSize:100]);
+}
+
+- (void)testCacheCostLimitEvicts {
+    // each 100 x 100 image costs at least 40,000 bytes, so the cache can't hold two of them
+
+    self.processor.cacheCostLimit = 60000;
+
+    NSURL *url1 = [NSURL URLWithString:@"http://image.test/1.png"];
+    NSURL *url2 = [NSURL URLWithString:@"http://image.test/2.png"];
+    [self processData:[self PNGDataWithPixelSize:CGSizeMake(100, 100)] url:url1 maximumPixelSize:100 error:nil];
+    [self processData:[self PNGDataWithPixelSize:CGSizeMake(100, 100)] url:url2 maximumPixelSize:100 error:nil];
+
+    BOOL bothCached = [self.processor cachedImageForURL:url1 maximumPixelSize:100] && [self.processor cachedImageForURL:url2 maximumPixelSize:100];
+    XCTAssertFalse(bothCached);
+}
+
+- (void)testDecodeConcurrencyIsBounded {
+    NSData *data = [self PNGDataWithPixelSize:CGSizeMake(2000, 2000)];
+    NSUInteger count = 12;
+    __block NSUInteger maximumExecuting = 0;
+    __block BOOL done = NO;
+
+    // sample the decode queue while it works through more images than it may decode at once
+
+    dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_HIGH, 0), ^{
+        while (!done) {
+            NSUInteger executing = 0;
+            for (NSOperation *operation in [self.processor.decodeQueue operations]) {
+                if ([operation isExecuting])
+                    executing++;
+            }
+            @synchronized(self) {
+                maximumExecuting = MAX(maximumExecuting, executing);
+            }
+            usleep(1000);
+        }
+    });
+
+    for (NSUInteger i = 0; i < count; i++) {
+        XCTestExpectation *expectation = [self expectationWithDescription:@"decoded"];
+        [self.processor processImageData:data forURL:nil maximumPixelSize:200 queue:nil completionHandler:^(UIImage *image, NSError *error) {
+            XCTAssertNotNil(image);
+            [expectation fulfill];
+        }];
+    }
+
+    [self waitForExpectationsWithTimeout:30 handler:nil];
+    done = YES;
+
+    @synchronized(self) {
+        XCTAssertGreaterThan(maximumExecuting, 0u);
+        XCTAssertLessThanOrEqual(maximumExecuting, 2u);
+    }
+}
+
+- (void)testIncrementalDecoderProducesPartialImages {
+    NSData *data = [self progressiveJPEGDataWithPixelSize:CGSizeMake(800, 800)];
+    NetworkIncrementalImageDecoder *decoder = [self.processor incrementalDecoderWithMaximumPixelSize:200];
+    NSMutableArray *partialImages = [NSMutableArray array];
+
+    // feed the first half, a chunk at a time, pausing after each, as a slow connection would
+
+    NSUInteger chunkLength = [data length] / 8;
+    for (NSUInteger offset = 0; offset < [data length] / 2; offset += chunkLength) {
+        [decoder appendData:[data subdataWithRange:NSMakeRange(offset, chunkLength)] queue:nil partialImageHandler:^(UIImage *partialImage) {
+            [partialImages addObject:partialImage];
+        }];
+        [[NSRunLoop currentRunLoop] runUntilDate:[NSDate dateWithTimeIntervalSinceNow:0.2]];
+    }
+
+    XCTAssertGreaterThan([partialImages count], 0u);
+    for (UIImage *image in partialImages) {
+        XCTAssertLessThanOrEqual(MAX(CGImageGetWidth(image.CGImage), CGImageGetHeight(image.CGImage)), 200u);
+    }
+}
+
+- (void)testIncrementalDecodesAreSpacedOutAsDataGrows {
+    NSData *data = [self progressiveJPEGDataWithPixelSize:CGSizeMake(800, 800)];
+    NetworkIncrementalImageDecoder *decoder = [self.processor incrementalDecoderWithMaximumPixelSize:200];
+
+    // feed it a few hundred bytes at a time, waiting for each chunk to be decoded if it's going to be
+
+    NSUInteger chunkLength = 256;
+    for (NSUInteger offset = 0; offset < [data length]; offset += chunkLength) {
+        [decoder appendData:[data subdataWithRange:NSMakeRange(offset, MIN(chunkLength, [data length] - offset))] queue:nil partialImageHandler:^(UIImage *partialImage) {}];
+        [[NSRunLoop currentRunLoop] runUntilDate:[NSDate dateWithTimeIntervalSinceNow:0.005]];
+    }
+
+    // each decode copies everything received, so there must be far fewer decodes than chunks: with each one waiting
+    // for the data to grow by a quarter, there are only a logarithmic number of them
+
+    NSUInteger chunkCount = ([data length] + chunkLength - 1) / chunkLength;
+    NSUInteger maximumDecodeCount = (NSUInteger)ceil(log((double)[data length] / 4096) / log(1.25)) + 1;
+
+    XCTAssertGreaterThan(decoder.decodeCount, 0u);
+    XCTAssertLessThanOrEqual(decoder.decodeCount, maximumDecodeCount);
+    XCTAssertLessThan(decoder.decodeCount, chunkCount);
+    XCTAssertEqualObjects([decoder finish], data);
+}
+
+- (void)testNoPartialImageAfterFinish {
+    NSData *data = [self progressiveJPEGDataWithPixelSize:CGSizeMake(800, 800)];
+    NetworkIncrementalImageDecoder *decoder = [self.processor incrementalDecoderWithMaximumPixelSize:200];
+    NSMutableArray *partialImages = [NSMutableArray array];
+
+    // partial images are delivered to this (main) thread, so while it's busy here, they can only be queued
+
+    NSUInteger chunkLength = [data length] / 4;
+    for (NSUInteger offset = 0; offset < [data length]; offset += chunkLength) {
+        [decoder appendData:[data subdataWithRange:NSMakeRange(offset, MIN(chunkLength, [data length] - offset))] queue:nil partialImageHandler:^(UIImage *partialImage) {
+            [partialImages addObject:partialImage];
+        }];
+        usleep(100000);
+    }
+
+    [decoder finish];
+
+    [[NSRunLoop currentRunLoop] runUntilDate:[NSDate dateWithTimeIntervalSinceNow:0.5]];
+
+    XCTAssertGreaterThan(decoder.decodeCount, 0u);
+    XCTAssertEqual([partialImages count], 0u);
+}
+
+- (void)testProgressiveImageRequest {
+    NSData *data = [self progressiveJPEGDataWithPixelSize:CGSizeMake(800, 800)];
+    [NetworkStubURLProtocol setResponseProvider:^NetworkStubResponse *(NSURLRequest *request, NSData *body) {
+        NetworkStubResponse *response = [NetworkStubResponse responseWithStatusCode:200 headerFields:@{@"Content-Type": @"image/jpeg"} data:data];
+        response.chunkSize = [data length] / 6 + 1;
+        response.chunkInterval = 0.1;
+        return response;
+    }];
+
+    NetworkManager *manager = [[NetworkManager alloc] initWithSessionConfiguration:[NetworkStubURLProtocol sessionConfiguration]];
+    NSURL *url = [NSURL URLWithString:@"http://image.test/progressive.jpg"];
+    XCTestExpectation *expectation = [self expectationWithDescription:@"complete"];
+    NSMutableArray *partialImages = [NSMutableArray array];
+    __block UIImage *finalImage;
+
+    [manager imageDataOperationWithURL:url maximumPixelSize:200 imageProcessor:self.processor partialImageHandler:^(UIImage *partialImage) {
+        XCTAssertNil(finalImage, @"partial image after the final one");
+        [partialImages addObject:partialImage];
+    } completion:^(UIImage *image, NSError *error) {
+        XCTAssertNil(error);
+        finalImage = image;
+        [expectation fulfill];
+    }];
+
+    [self waitForExpectationsWithTimeout:10 handler:nil];
+
+    // give any partial image still being decoded the chance to (wrongly) arrive
+
+    [[NSRunLoop currentRunLoop] runUntilDate:[NSDate dateWithTimeIntervalSinceNow:0.5]];
+
+    XCTAssertGreaterThan([partialImages count], 0u);
+    XCTAssertEqual(CGImageGetWidth(finalImage.CGImage), 200u);
+    XCTAssertNotNil([self.processor cachedImageForURL:url maximumPixelSize:200]);
+}
+
+@end
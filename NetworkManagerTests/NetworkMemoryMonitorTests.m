@@ -0,0 +1,223 @@
+//
+//  NetworkMemoryMonitorTests.m
+//  NetworkManagerTests
+//
+//  Created by agent on 10/19/26.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+
+#import <XCTest/XCTest.h>
+#import "NetworkManager.h"
+#import "NetworkStubURLProtocol.h"
+
+static int64_t const kKB = 1024;
+
+@interface NetworkMemoryMonitorTests : XCTestCase
+
+@property (nonatomic, strong) NetworkMemoryMonitor *monitor;
+@property (nonatomic, strong) NetworkManager *manager;
+@property (nonatomic, strong) dispatch_queue_t completionQueue;
+
+@end
+
+@implementation NetworkMemoryMonitorTests
+
+- (void)setUp {
+    [super setUp];
+
+    self.monitor = [[NetworkMemoryMonitor alloc] init];
+    self.monitor.highWatermark = 100 * kKB;
+    self.monitor.lowWatermark = 50 * kKB;
+    self.monitor.spillThreshold = 16 * kKB;
+    self.monitor.escalationInterval = 0;
+
+    self.completionQueue = dispatch_queue_create("NetworkMemoryMonitorTests.completion", DISPATCH_QUEUE_SERIAL);
+
+    [NetworkStubURLProtocol reset];
+}
+
+- (void)tearDown {
+    [[self.manager networkQueue] cancelAllOperations];
+    [NetworkStubURLProtocol reset];
+
+    [super tearDown];
+}
+
+#pragma mark - Helpers
+
+/* An operation without a task, fed its response by hand, as the session would.
+ */
+- (NetworkDataTaskOperation *)operationWithBulk:(BOOL)bulk {
+    NetworkDataTaskOperation *operation = [[NetworkDataTaskOperation alloc] initWithSession:nil request:[NSURLRequest requestWithURL:[NSURL URLWithString:@"http://memory.test/"]]];
+    operation.memoryMonitor = self.monitor;
+    operation.completionQueue = self.completionQueue;
+    operation.bulk = bulk;
+    return operation;
+}
+
+- (NSData *)dataWithLength:(NSUInteger)length seed:(uint8_t)seed {
+    NSMutableData *data = [NSMutableData dataWithLength:length];
+    for (NSUInteger i = 0; i < length; i++) {
+        ((uint8_t *)[data mutableBytes])[i] = (uint8_t)(i + seed);
+    }
+    return data;
+}
+
+- (void)operation:(NetworkDataTaskOperation *)operation receiveData:(NSData *)data {
+    [operation URLSession:nil dataTask:nil didReceiveData:data];
+}
+
+- (NSData *)completeOperation:(NetworkDataTaskOperation *)operation {
+    __block NSData *responseData;
+
+    operation.didCompleteWithDataErrorHandler = ^(NetworkTaskOperation *operation, NSData *data, NSError *error) {
+        responseData = data;
+    };
+    [operation URLSession:nil task:nil didCompleteWithError:nil];
+
+    return responseData;
+}
+
+#pragma mark - Tests
+
+- (void)testBuffersAreSpilledOnEnteringSpillStep {
+    NetworkDataTaskOperation *operation1 = [self operationWithBulk:NO];
+    NetworkDataTaskOperation *operation2 = [self operationWithBulk:NO];
+    NetworkDataTaskOperation *uploader = [self operationWithBulk:NO];
+    NSData *data1 = [self dataWithLength:40 * kKB seed:1];
+    NSData *data2 = [self dataWithLength:40 * kKB seed:2];
+
+    [self operation:operation1 receiveData:data1];
+    [self operation:operation2 receiveData:data2];
+    XCTAssertEqual(self.monitor.shedding, NetworkMemorySheddingNone);
+    XCTAssertEqual(self.monitor.responseBufferBytes, 80 * kKB);
+
+    // something else pushes usage over the high watermark; neither response gets any more data, but both spill
+
+    [self.monitor operation:uploader didAddBytes:30 * kKB category:NetworkMemoryCategoryQueuedBody];
+
+    XCTAssertEqual(self.monitor.spillCount, 2u);
+    XCTAssertEqual(self.monitor.spilledBytes, 80 * kKB);
+    XCTAssertEqual(self.monitor.responseBufferBytes, 0);
+    XCTAssertEqual(self.monitor.peakBytes, 110 * kKB);
+
+    // which brings usage back below the low watermark
+
+    XCTAssertEqual(self.monitor.shedding, NetworkMemorySheddingNone);
+
+    XCTAssertEqualObjects([self completeOperation:operation1], data1);
+    XCTAssertEqualObjects([self completeOperation:operation2], data2);
+}
+
+- (void)testSmallBuffersAreNotSpilled {
+    NetworkDataTaskOperation *operation = [self operationWithBulk:NO];
+    NetworkDataTaskOperation *uploader = [self operationWithBulk:NO];
+
+    [self operation:operation receiveData:[self dataWithLength:8 * kKB seed:0]];
+    [self.monitor operation:uploader didAddBytes:120 * kKB category:NetworkMemoryCategoryQueuedBody];
+
+    XCTAssertEqual(self.monitor.spillCount, 0u);
+    XCTAssertEqual(self.monitor.responseBufferBytes, 8 * kKB);
+}
+
+- (void)testPressureUpAndDown {
+    NetworkDataTaskOperation *bulk = [self operationWithBulk:YES];
+    NetworkDataTaskOperation *uploader = [self operationWithBulk:NO];
+    NSData *first = [self dataWithLength:40 * kKB seed:3];
+    NSData *second = [self dataWithLength:20 * kKB seed:4];
+
+    [self.monitor operationDidStart:bulk];
+    [self operation:bulk receiveData:first];
+
+    // up: usage stays high (the queued body can't be spilled), so the monitor escalates a step per evaluation
+    // (the spill itself being one), spilling the bulk operation's buffer before it suspends its task
+
+    [self.monitor operation:uploader didAddBytes:200 * kKB category:NetworkMemoryCategoryQueuedBody];
+    XCTAssertEqual(self.monitor.spillCount, 1u);
+    XCTAssertEqual(self.monitor.responseBufferBytes, 0);
+    XCTAssertEqual(self.monitor.shedding, NetworkMemorySheddingPauseBulk);
+    XCTAssertEqual(self.monitor.pausedOperationCount, 1u);
+
+    [self.monitor operation:uploader didAddBytes:0 category:NetworkMemoryCategoryQueuedBody];
+    XCTAssertEqual(self.monitor.shedding, NetworkMemorySheddingRejectBulk);
+
+    NSError *error;
+    XCTAssertFalse([self.monitor shouldAcceptOperation:[self operationWithBulk:YES] error:&error]);
+    XCTAssertEqualObjects(error.domain, kNetworkMemoryMonitorErrorDomain);
+    XCTAssertTrue([self.monitor shouldAcceptOperation:[self operationWithBulk:NO] error:nil]);
+
+    // down: once the body is sent, usage falls below the low watermark, and the bulk operation is resumed
+
+    [self.monitor operation:uploader didAddBytes:-200 * kKB category:NetworkMemoryCategoryQueuedBody];
+    XCTAssertEqual(self.monitor.shedding, NetworkMemorySheddingNone);
+    XCTAssertEqual(self.monitor.pausedOperationCount, 0u);
+    XCTAssertTrue([self.monitor shouldAcceptOperation:[self operationWithBulk:YES] error:nil]);
+
+    // the rest of the response goes to the spill file, and the whole response is delivered
+
+    [self operation:bulk receiveData:second];
+    XCTAssertEqual(self.monitor.responseBufferBytes, 0);
+
+    NSMutableData *expected = [first mutableCopy];
+    [expected appendData:second];
+    XCTAssertEqualObjects([self completeOperation:bulk], expected);
+
+    [self.monitor operationDidFinish:uploader];
+    XCTAssertEqual(self.monitor.currentBytes, 0);
+}
+
+- (void)testSuspendedRequestCompletesAfterPressureSubsides {
+    NSData *data = [self dataWithLength:256 * kKB seed:5];
+    [NetworkStubURLProtocol setResponseProvider:^NetworkStubResponse *(NSURLRequest *request, NSData *body) {
+        NetworkStubResponse *response = [NetworkStubResponse responseWithStatusCode:200 headerFields:nil data:data];
+        response.chunkSize = 16 * kKB;
+        response.chunkInterval = 0.05;
+        return response;
+    }];
+
+    self.manager = [[NetworkManager alloc] initWithSessionConfiguration:[NetworkStubURLProtocol sessionConfiguration]];
+    self.manager.memoryMonitor = self.monitor;
+    self.monitor.highWatermark = 1024 * kKB;
+    self.monitor.lowWatermark = 512 * kKB;
+
+    XCTestExpectation *expectation = [self expectationWithDescription:@"complete"];
+    __block NSData *responseData;
+
+    NetworkDataTaskOperation *operation = [self.manager dataOperationWithURL:[NSURL URLWithString:@"http://memory.test/bulk"] progressHandler:nil completionHandler:^(NetworkTaskOperation *operation, NSData *data, NSError *error) {
+        XCTAssertNil(error);
+        responseData = data;
+        [expectation fulfill];
+    }];
+    operation.bulk = YES;
+    [self.manager addOperation:operation];
+
+    // wait until part of the response is buffered, then drive pressure all the way up
+
+    NSDate *deadline = [NSDate dateWithTimeIntervalSinceNow:10];
+    while (self.monitor.responseBufferBytes <= (int64_t)self.monitor.spillThreshold && [deadline timeIntervalSinceNow] > 0) {
+        [[NSRunLoop currentRunLoop] runUntilDate:[NSDate dateWithTimeIntervalSinceNow:0.02]];
+    }
+    XCTAssertGreaterThan(self.monitor.responseBufferBytes, (int64_t)self.monitor.spillThreshold, @"the response should have been partly buffered by now");
+
+    NetworkDataTaskOperation *uploader = [self operationWithBulk:NO];
+    for (NSUInteger i = 0; i < 3; i++) {
+        [self.monitor operation:uploader didAddBytes:(i == 0 ? 2048 * kKB : 0) category:NetworkMemoryCategoryQueuedBody];
+    }
+    XCTAssertEqual(self.monitor.shedding, NetworkMemorySheddingRejectBulk);
+    XCTAssertEqual(self.monitor.pausedOperationCount, 1u);
+    XCTAssertGreaterThanOrEqual(self.monitor.spillCount, 1u, @"the buffer should have been spilled before the task was suspended");
+
+    [[NSRunLoop currentRunLoop] runUntilDate:[NSDate dateWithTimeIntervalSinceNow:0.3]];
+
+    // then let it back down
+
+    [self.monitor operation:uploader didAddBytes:-2048 * kKB category:NetworkMemoryCategoryQueuedBody];
+    XCTAssertEqual(self.monitor.shedding, NetworkMemorySheddingNone);
+    XCTAssertEqual(self.monitor.pausedOperationCount, 0u);
+
+    [self waitForExpectationsWithTimeout:20 handler:nil];
+
+    XCTAssertEqualObjects(responseData, data);
+}
+
+@end
@@ -0,0 +1,228 @@
+//
+//  NetworkPrefetchControllerTests.m
+//  NetworkManagerTests
+//
+//  Created by agent on 10/19/26.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+
+#import <XCTest/XCTest.h>
+#import "NetworkManager.h"
+#import "NetworkPrefetchController.h"
+#import "NetworkStubURLProtocol.h"
+
+/* A stand-in for a download, which stays in progress until the test finishes it (or finishes as soon as it starts).
+ */
+@interface NetworkStandInOperation : NetworkTaskOperation
+@property (nonatomic, strong) NSURL *url;
+@property (nonatomic) BOOL finishesImmediately;
+@end
+
+@implementation NetworkStandInOperation
+
+- (void)start {
+    [super start];
+
+    if (self.finishesImmediately && [self isExecuting])
+        [self completeOperation];
+}
+
+@end
+
+
+@interface NetworkPrefetchControllerTests : XCTestCase
+
+@property (nonatomic, strong) NetworkManager *manager;
+@property (nonatomic, strong) NetworkPrefetchController *controller;
+@property (nonatomic, strong) NSMutableArray *createdOperations;
+@property (nonatomic) BOOL operationsFinishImmediately;
+
+@end
+
+@implementation NetworkPrefetchControllerTests
+
+- (void)setUp {
+    [super setUp];
+
+    self.manager = [[NetworkManager alloc] initWithSessionConfiguration:[NetworkStubURLProtocol sessionConfiguration]];
+    self.createdOperations = [NSMutableArray array];
+
+    NSMutableArray *urls = [NSMutableArray array];
+    for (NSUInteger i = 0; i < 100; i++) {
+        [urls addObject:[NSURL URLWithString:[NSString stringWithFormat:@"http://prefetch.test/%lu.jpg", (unsigned long)i]]];
+    }
+
+    self.controller = [[NetworkPrefetchController alloc] initWithManager:self.manager];
+    self.controller.urls = urls;
+    self.controller.nearDistance = 3;
+
+    __weak typeof(self) weakSelf = self;
+    self.controller.operationProvider = ^NetworkTaskOperation *(NetworkPrefetchController *controller, NSURL *url, NSData *resumeData) {
+        NetworkStandInOperation *operation = [[NetworkStandInOperation alloc] init];
+        operation.url = url;
+        operation.finishesImmediately = weakSelf.operationsFinishImmediately;
+        [weakSelf.createdOperations addObject:operation];
+        return operation;
+    };
+}
+
+- (void)tearDown {
+    [self.controller cancelAll];
+    [[self.manager networkQueue] cancelAllOperations];
+
+    [super tearDown];
+}
+
+/* Replay a scroll trace: the first visible row of each step, with `rows` rows visible.
+ */
+- (void)replayTrace:(NSArray *)firstRows rows:(NSUInteger)rows {
+    for (NSNumber *firstRow in firstRows) {
+        [self.controller updateVisibleRange:NSMakeRange([firstRow unsignedIntegerValue], rows)];
+    }
+}
+
+/* Wait for the created operations to finish, and for the controller to let go of them.
+ */
+- (void)waitForCreatedOperationsToBeReleased {
+    for (NSOperation *operation in self.createdOperations) {
+        [self keyValueObservingExpectationForObject:operation keyPath:@"isFinished" expectedValue:@YES];
+    }
+    [self waitForExpectationsWithTimeout:5 handler:nil];
+
+    // the controller is told in the operations' completion blocks, which run after they finish
+
+    NSDate *deadline = [NSDate dateWithTimeIntervalSinceNow:5];
+    for (NetworkStandInOperation *operation in self.createdOperations) {
+        while ([self.controller operationForURL:operation.url] && [deadline timeIntervalSinceNow] > 0) {
+            [[NSRunLoop currentRunLoop] runUntilDate:[NSDate dateWithTimeIntervalSinceNow:0.01]];
+        }
+        XCTAssertNil([self.controller operationForURL:operation.url]);
+    }
+}
+
+- (NSArray *)rowsFrom:(NSUInteger)from to:(NSUInteger)to {
+    NSMutableArray *rows = [NSMutableArray array];
+    NSInteger step = to >= from ? 1 : -1;
+    for (NSInteger row = (NSInteger)from; row != (NSInteger)to + step; row += step) {
+        [rows addObject:@(row)];
+    }
+    return rows;
+}
+
+#pragma mark - Tests
+
+- (void)testRepeatedUpdatesAreNotCountedAsReuse {
+    // scroll events often report the same visible range many times over
+
+    [self replayTrace:@[@0, @0, @0, @0, @0] rows:5];
+
+    XCTAssertEqual(self.controller.startedCount, 8u, @"5 visible and 3 near");
+    XCTAssertEqual(self.controller.reusedCount, 0u);
+    XCTAssertEqual([self.createdOperations count], 8u);
+}
+
+- (void)testNearPrefetchIsReusedWhenItBecomesVisible {
+    [self replayTrace:@[@0] rows:5];
+
+    // each step down, one near row becomes visible, and one row becomes near
+
+    [self replayTrace:[self rowsFrom:1 to:10] rows:5];
+    XCTAssertEqual(self.controller.reusedCount, 10u);
+    XCTAssertEqual(self.controller.startedCount, 8u + 10u);
+
+    // rows scrolled off the top become near, then far; nothing is counted for demotion, or for standing still
+
+    [self replayTrace:@[@10, @10, @10] rows:5];
+    XCTAssertEqual(self.controller.reusedCount, 10u);
+    XCTAssertEqual(self.controller.canceledCount, 10u - 3u);
+
+    // scrolling back up, each row above the visible range was near (its prefetch deprioritized, not canceled)
+
+    [self replayTrace:[self rowsFrom:9 to:7] rows:5];
+    XCTAssertEqual(self.controller.reusedCount, 13u);
+}
+
+- (void)testFinishedPrefetchIsNotReused {
+    self.operationsFinishImmediately = YES;
+
+    [self replayTrace:@[@0] rows:5];
+
+    for (NSOperation *operation in self.createdOperations) {
+        [self keyValueObservingExpectationForObject:operation keyPath:@"isFinished" expectedValue:@YES];
+    }
+    [self waitForExpectationsWithTimeout:5 handler:nil];
+
+    [self replayTrace:[self rowsFrom:1 to:3] rows:5];
+
+    XCTAssertEqual(self.controller.reusedCount, 0u);
+    XCTAssertEqual(self.controller.startedCount, 8u + 3u, @"finished rows aren't downloaded again");
+}
+
+- (void)testFinishedOperationsAreReleased {
+    self.operationsFinishImmediately = YES;
+
+    [self replayTrace:@[@0] rows:5];
+    [self waitForCreatedOperationsToBeReleased];
+
+    // their URLs are remembered, though, so they aren't downloaded again, even after becoming far and coming back
+
+    [self replayTrace:@[@0] rows:5];
+    [self.controller setVisibility:NetworkPrefetchVisibilityFar forURLs:[self.controller.urls subarrayWithRange:NSMakeRange(0, 8)]];
+    [self replayTrace:@[@0] rows:5];
+
+    XCTAssertEqual(self.controller.startedCount, 8u);
+    XCTAssertEqual(self.controller.canceledCount, 0u);
+}
+
+- (void)testFinishedURLsAreBounded {
+    self.operationsFinishImmediately = YES;
+    self.controller.finishedURLLimit = 5;
+
+    [self replayTrace:@[@0] rows:5];
+    [self waitForCreatedOperationsToBeReleased];
+
+    // only the last five are remembered, so the other three are downloaded again
+
+    [self.controller setVisibility:NetworkPrefetchVisibilityNear forURLs:[self.controller.urls subarrayWithRange:NSMakeRange(0, 8)]];
+    XCTAssertEqual(self.controller.startedCount, 8u + 3u);
+}
+
+- (void)testPrefetchOperationsAreBulk {
+    [self replayTrace:@[@0] rows:5];
+
+    XCTAssertEqual([self.createdOperations count], 8u);
+    for (NetworkTaskOperation *operation in self.createdOperations) {
+        XCTAssertTrue([operation isBulk]);
+    }
+}
+
+- (void)testFarRowIsCanceledAndStartedAgain {
+    [self replayTrace:@[@0] rows:5];
+    NSURL *url = self.controller.urls[0];
+    NetworkTaskOperation *first = [self.controller operationForURL:url];
+
+    [self replayTrace:@[@20] rows:5];
+    XCTAssertTrue([first isCancelled]);
+    XCTAssertEqual([self.controller visibilityForURL:url], NetworkPrefetchVisibilityFar);
+    XCTAssertNil([self.controller operationForURL:url]);
+
+    [self replayTrace:@[@0] rows:5];
+    NetworkTaskOperation *second = [self.controller operationForURL:url];
+    XCTAssertNotNil(second);
+    XCTAssertNotEqual(first, second);
+    XCTAssertEqual(self.controller.reusedCount, 0u, @"a canceled prefetch is restarted, not reused");
+}
+
+- (void)testVisibleRowsArePrioritized {
+    [self replayTrace:@[@0] rows:5];
+
+    XCTAssertEqual([[self.controller operationForURL:self.controller.urls[0]] queuePriority], NSOperationQueuePriorityVeryHigh);
+    XCTAssertEqual([[self.controller operationForURL:self.controller.urls[6]] queuePriority], NSOperationQueuePriorityVeryLow);
+
+    [self replayTrace:@[@2] rows:5];
+
+    XCTAssertEqual([[self.controller operationForURL:self.controller.urls[6]] queuePriority], NSOperationQueuePriorityVeryHigh);
+    XCTAssertEqual([[self.controller operationForURL:self.controller.urls[0]] queuePriority], NSOperationQueuePriorityVeryLow);
+}
+
+@end
@@ -0,0 +1,277 @@
+//
+//  NetworkRequestBatcherTests.m
+//  NetworkManagerTests
+//
+//  Created by agent on 10/19/26.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+
+#import <XCTest/XCTest.h>
+#import "NetworkManager+HTTP.h"
+#import "NetworkRequestBatcher.h"
+#import "NetworkStubURLProtocol.h"
+
+@interface NetworkRequestBatcherTests : XCTestCase
+
+@property (nonatomic, strong) NetworkManager *manager;
+@property (nonatomic, strong) NSMutableArray *batchSizes;
+@property (nonatomic, strong) NSMutableArray *batchAuthorizations;
+
+@end
+
+@implementation NetworkRequestBatcherTests
+
+- (void)setUp {
+    [super setUp];
+
+    [NetworkStubURLProtocol reset];
+
+    // a stand-in for a server with a JSON batch endpoint: `/api/missing` is a 404 (with a JSON body), anything else
+    // echoes its path and body
+
+    NSMutableArray *batchSizes = [NSMutableArray array];
+    NSMutableArray *batchAuthorizations = [NSMutableArray array];
+    self.batchSizes = batchSizes;
+    self.batchAuthorizations = batchAuthorizations;
+
+    NSDictionary *JSONHeaders = @{@"Content-Type": @"application/json"};
+
+    [NetworkStubURLProtocol setResponseProvider:^NetworkStubResponse *(NSURLRequest *request, NSData *body) {
+        if (![request.URL.path isEqualToString:@"/batch"]) {
+            NSData *data = [NSJSONSerialization dataWithJSONObject:@{@"path": request.URL.path, @"single": @YES} options:0 error:nil];
+            return [NetworkStubResponse responseWithStatusCode:200 headerFields:JSONHeaders data:data];
+        }
+
+        NSArray *items = [NSJSONSerialization JSONObjectWithData:body options:0 error:nil];
+        [batchSizes addObject:@([items count])];
+        [batchAuthorizations addObject:[request valueForHTTPHeaderField:@"Authorization"] ?: @""];
+
+        NSMutableArray *responses = [NSMutableArray array];
+        for (NSDictionary *item in [items reverseObjectEnumerator]) {
+            BOOL missing = [item[@"path"] hasPrefix:@"/api/missing"];
+            [responses addObject:@{@"id": item[@"id"],
+                                   @"status": missing ? @404 : @200,
+                                   @"headers": JSONHeaders,
+                                   @"body": missing ? @{@"error": @"not found"} : @{@"path": item[@"path"], @"body": item[@"body"] ?: @""}}];
+        }
+
+        return [NetworkStubResponse responseWithStatusCode:200 headerFields:JSONHeaders data:[NSJSONSerialization dataWithJSONObject:responses options:0 error:nil]];
+    }];
+
+    self.manager = [[NetworkManager alloc] initWithSessionConfiguration:[NetworkStubURLProtocol sessionConfiguration]];
+    self.manager.requestBatcher = [[NetworkRequestBatcher alloc] initWithManager:self.manager envelope:[[NetworkJSONBatchEnvelope alloc] init]];
+}
+
+- (void)tearDown {
+    [[self.manager networkQueue] cancelAllOperations];
+    [NetworkStubURLProtocol reset];
+
+    [super tearDown];
+}
+
+- (NSURL *)URLWithPath:(NSString *)path {
+    return [NSURL URLWithString:[@"http://batch.test" stringByAppendingString:path]];
+}
+
+#pragma mark - Batching
+
+- (void)testPostsAreCombinedIntoOneRequest {
+    NSMutableDictionary *results = [NSMutableDictionary dictionary];
+
+    for (NSUInteger i = 0; i < 3; i++) {
+        XCTestExpectation *expectation = [self expectationWithDescription:@"complete"];
+        NSString *path = [NSString stringWithFormat:@"/api/like/%lu", (unsigned long)i];
+
+        NetworkDataTaskOperation *operation = [self.manager post:[self URLWithPath:path] parameters:@{@"value": @(i)} completion:^(id responseObject, NSError *error) {
+            XCTAssertTrue([NSThread isMainThread]);
+            XCTAssertNil(error);
+            results[path] = responseObject;
+            [expectation fulfill];
+        }];
+
+        XCTAssertNil(operation, @"there is no operation for a batched request");
+    }
+
+    [self waitForExpectationsWithTimeout:5 handler:nil];
+
+    XCTAssertEqual([NetworkStubURLProtocol requestCount], 1u);
+    XCTAssertEqualObjects(self.batchSizes, @[@3]);
+
+    // each completion gets its own response, even though the server answered in a different order
+
+    for (NSUInteger i = 0; i < 3; i++) {
+        NSString *path = [NSString stringWithFormat:@"/api/like/%lu", (unsigned long)i];
+        XCTAssertEqualObjects(results[path][@"path"], path);
+        XCTAssertEqualObjects(results[path][@"body"], ([NSString stringWithFormat:@"value=%lu", (unsigned long)i]));
+    }
+}
+
+- (void)testNon2xxItemReportsItsErrorWithParsedBody {
+    XCTestExpectation *found = [self expectationWithDescription:@"found"];
+    XCTestExpectation *missing = [self expectationWithDescription:@"missing"];
+
+    [self.manager post:[self URLWithPath:@"/api/like/1"] parameters:nil completion:^(id responseObject, NSError *error) {
+        XCTAssertNil(error);
+        [found fulfill];
+    }];
+
+    [self.manager post:[self URLWithPath:@"/api/missing"] parameters:nil completion:^(id responseObject, NSError *error) {
+        // the body is JSON, and parses fine, but the request still failed
+
+        XCTAssertEqualObjects(responseObject, @{@"error": @"not found"});
+        XCTAssertNotNil(error);
+        XCTAssertEqual(error.code, 404);
+        [missing fulfill];
+    }];
+
+    [self waitForExpectationsWithTimeout:5 handler:nil];
+}
+
+- (void)testSingleRequestIsSentAsIs {
+    XCTestExpectation *expectation = [self expectationWithDescription:@"complete"];
+
+    [self.manager post:[self URLWithPath:@"/api/alone"] parameters:nil completion:^(id responseObject, NSError *error) {
+        XCTAssertNil(error);
+        XCTAssertEqualObjects(responseObject[@"single"], @YES);
+        [expectation fulfill];
+    }];
+
+    [self waitForExpectationsWithTimeout:5 handler:nil];
+
+    XCTAssertEqual([self.batchSizes count], 0u);
+}
+
+- (void)testMaximumBatchSizeSendsRightAway {
+    self.manager.requestBatcher.maximumBatchSize = 2;
+    self.manager.requestBatcher.batchWindow = 10;
+
+    for (NSUInteger i = 0; i < 4; i++) {
+        XCTestExpectation *expectation = [self expectationWithDescription:@"complete"];
+        [self.manager post:[self URLWithPath:[NSString stringWithFormat:@"/api/like/%lu", (unsigned long)i]] parameters:nil completion:^(id responseObject, NSError *error) {
+            [expectation fulfill];
+        }];
+    }
+
+    [self waitForExpectationsWithTimeout:5 handler:nil];
+
+    XCTAssertEqualObjects(self.batchSizes, (@[@2, @2]));
+}
+
+- (void)testOnlyRequestsWithSameCredentialsAreCombined {
+    NSArray *authorizations = @[@"Bearer alice", @"Bearer bob", @"Bearer alice", @"Bearer bob", @"Bearer alice"];
+
+    for (NSString *authorization in authorizations) {
+        XCTestExpectation *expectation = [self expectationWithDescription:@"complete"];
+        NSMutableURLRequest *request = [NSMutableURLRequest requestWithURL:[self URLWithPath:@"/api/like/1"]];
+        request.HTTPMethod = @"POST";
+        [request setValue:authorization forHTTPHeaderField:@"Authorization"];
+
+        [self.manager.requestBatcher enqueueRequest:request completionHandler:^(NSHTTPURLResponse *response, NSData *data, NSError *error) {
+            XCTAssertNil(error);
+            [expectation fulfill];
+        }];
+    }
+
+    [self waitForExpectationsWithTimeout:5 handler:nil];
+
+    // one batch per user, each sent with that user's credentials
+
+    XCTAssertEqual([self.batchSizes count], 2u);
+    NSDictionary *sizesByAuthorization = [NSDictionary dictionaryWithObjects:self.batchSizes forKeys:self.batchAuthorizations];
+    XCTAssertEqualObjects(sizesByAuthorization, (@{@"Bearer alice": @3, @"Bearer bob": @2}));
+}
+
+- (void)testPostReturnsOperationWithoutBatcher {
+    self.manager.requestBatcher = nil;
+    XCTestExpectation *expectation = [self expectationWithDescription:@"complete"];
+
+    NetworkDataTaskOperation *operation = [self.manager post:[self URLWithPath:@"/api/alone"] parameters:nil completion:^(id responseObject, NSError *error) {
+        [expectation fulfill];
+    }];
+
+    XCTAssertNotNil(operation);
+    [self waitForExpectationsWithTimeout:5 handler:nil];
+}
+
+#pragma mark - Envelopes
+
+- (NSArray *)requestsWithCount:(NSUInteger)count {
+    NSMutableArray *requests = [NSMutableArray array];
+    for (NSUInteger i = 0; i < count; i++) {
+        NSMutableURLRequest *request = [NSMutableURLRequest requestWithURL:[self URLWithPath:[NSString stringWithFormat:@"/api/item?id=%lu", (unsigned long)i]]];
+        request.HTTPMethod = @"POST";
+        request.HTTPBody = [[NSString stringWithFormat:@"value=%lu", (unsigned long)i] dataUsingEncoding:NSUTF8StringEncoding];
+        [request setValue:@"application/x-www-form-urlencoded" forHTTPHeaderField:@"Content-Type"];
+        [requests addObject:request];
+    }
+    return requests;
+}
+
+- (void)testJSONEnvelopeRoundTrip {
+    NetworkJSONBatchEnvelope *envelope = [[NetworkJSONBatchEnvelope alloc] init];
+    NSArray *requests = [self requestsWithCount:3];
+
+    NSURLRequest *batchRequest = [envelope batchRequestWithURL:[self URLWithPath:@"/batch"] requests:requests];
+    NSArray *items = [NSJSONSerialization JSONObjectWithData:batchRequest.HTTPBody options:0 error:nil];
+    XCTAssertEqual([items count], 3u);
+    XCTAssertEqualObjects(items[1][@"path"], @"/api/item?id=1");
+    XCTAssertEqualObjects(items[1][@"body"], @"value=1");
+
+    // item 2 gets no response
+
+    NSArray *responses = @[@{@"id": @"1", @"status": @201, @"body": @"created"},
+                           @{@"id": @"0", @"status": @200, @"headers": @{@"Content-Type": @"application/json"}, @"body": @{@"ok": @YES}}];
+    NSHTTPURLResponse *response = [[NSHTTPURLResponse alloc] initWithURL:batchRequest.URL statusCode:200 HTTPVersion:@"HTTP/1.1" headerFields:nil];
+
+    NSError *error;
+    NSArray *results = [envelope itemResponsesWithData:[NSJSONSerialization dataWithJSONObject:responses options:0 error:nil] response:response requests:requests error:&error];
+
+    XCTAssertEqual([results count], 3u);
+    XCTAssertEqual([results[0] response].statusCode, 200);
+    XCTAssertEqualObjects([NSJSONSerialization JSONObjectWithData:[results[0] data] options:0 error:nil], @{@"ok": @YES});
+    XCTAssertEqual([results[1] response].statusCode, 201);
+    XCTAssertEqualObjects([results[1] data], [@"created" dataUsingEncoding:NSUTF8StringEncoding]);
+    XCTAssertTrue([results[2] isKindOfClass:[NSError class]]);
+    XCTAssertEqual([results[2] code], NetworkBatchEnvelopeErrorCodeMissingResponse);
+
+    XCTAssertNil([envelope itemResponsesWithData:[@"<html>" dataUsingEncoding:NSUTF8StringEncoding] response:response requests:requests error:&error]);
+    XCTAssertEqual(error.code, NetworkBatchEnvelopeErrorCodeMalformedResponse);
+}
+
+- (void)testMultipartEnvelopeRoundTrip {
+    NetworkMultipartBatchEnvelope *envelope = [[NetworkMultipartBatchEnvelope alloc] init];
+    NSArray *requests = [self requestsWithCount:2];
+
+    NSURLRequest *batchRequest = [envelope batchRequestWithURL:[self URLWithPath:@"/batch"] requests:requests];
+    NSString *body = [[NSString alloc] initWithData:batchRequest.HTTPBody encoding:NSUTF8StringEncoding];
+    XCTAssertTrue([[batchRequest valueForHTTPHeaderField:@"Content-Type"] hasPrefix:@"multipart/mixed; boundary="]);
+    XCTAssertTrue([body containsString:@"Content-ID: <item-1>\r\n\r\nPOST /api/item?id=1 HTTP/1.1\r\n"]);
+    XCTAssertTrue([body containsString:@"\r\n\r\nvalue=1\r\n"]);
+
+    // the responses, out of order, identified by Content-ID
+
+    NSString *responseBody = @"--resp\r\n"
+                             @"Content-Type: application/http\r\n"
+                             @"Content-ID: <response-item-1>\r\n\r\n"
+                             @"HTTP/1.1 404 Not Found\r\n"
+                             @"Content-Type: text/plain\r\n\r\n"
+                             @"nope\r\n"
+                             @"--resp\r\n"
+                             @"Content-Type: application/http\r\n"
+                             @"Content-ID: <response-item-0>\r\n\r\n"
+                             @"HTTP/1.1 200 OK\r\n"
+                             @"Content-Type: application/json\r\n\r\n"
+                             @"{\"ok\":true}\r\n"
+                             @"--resp--\r\n";
+    NSHTTPURLResponse *response = [[NSHTTPURLResponse alloc] initWithURL:batchRequest.URL statusCode:200 HTTPVersion:@"HTTP/1.1" headerFields:@{@"Content-Type": @"multipart/mixed; boundary=resp"}];
+
+    NSArray *results = [envelope itemResponsesWithData:[responseBody dataUsingEncoding:NSUTF8StringEncoding] response:response requests:requests error:nil];
+
+    XCTAssertEqual([results count], 2u);
+    XCTAssertEqual([results[0] response].statusCode, 200);
+    XCTAssertEqualObjects([results[0] data], [@"{\"ok\":true}" dataUsingEncoding:NSUTF8StringEncoding]);
+    XCTAssertEqual([results[1] response].statusCode, 404);
+    XCTAssertEqualObjects([results[1] data], [@"nope" dataUsingEncoding:NSUTF8StringEncoding]);
+}
+
+@end
@@ -0,0 +1,255 @@
+//
+//  NetworkResumableUploadTests.m
+//  NetworkManagerTests
+//
+//  Created by agent on 10/19/26.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+
+#import <XCTest/XCTest.h>
+#import "NetworkManager.h"
+#import "NetworkStubURLProtocol.h"
+
+/** A stand-in tus core server.
+
+ `POST /files` creates an upload; `PATCH /files/<id>` appends to it, but only at its current offset (anything
+ else is a `409 Conflict`, as the tus core protocol requires); `HEAD /files/<id>` returns its current offset.
+
+ A `PATCH` whose body doesn't match its `Content-Length` is a `400 Bad Request`. A `PATCH` at `interruptPatchAtOffset`
+ is cut short: the server keeps its first `interruptedPatchBytesKept` bytes (as a tus server does when the connection
+ drops) and fails.
+ */
+@interface NetworkTusStandInServer : NSObject
+
+@property (nonatomic, strong) NSMutableDictionary *uploads;
+@property (nonatomic, strong) NSMutableArray *methods;
+@property (nonatomic) NSUInteger conflictCount;
+@property (nonatomic) int64_t failPatchAtOffset;
+@property (nonatomic) int64_t interruptPatchAtOffset;
+@property (nonatomic) NSUInteger interruptedPatchBytesKept;
+@property (nonatomic) BOOL forgetsUploads;
+
+- (NetworkStubResponse *)responseForRequest:(NSURLRequest *)request body:(NSData *)body;
+
+@end
+
+@implementation NetworkTusStandInServer
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        _uploads = [NSMutableDictionary dictionary];
+        _methods = [NSMutableArray array];
+        _failPatchAtOffset = -1;
+        _interruptPatchAtOffset = -1;
+    }
+    return self;
+}
+
+- (NetworkStubResponse *)responseForRequest:(NSURLRequest *)request body:(NSData *)body {
+    [self.methods addObject:request.HTTPMethod];
+
+    if (![[request valueForHTTPHeaderField:@"Tus-Resumable"] isEqualToString:@"1.0.0"])
+        return [NetworkStubResponse responseWithStatusCode:412 headerFields:nil data:nil];
+
+    if ([request.HTTPMethod isEqualToString:@"POST"]) {
+        NSString *identifier = [NSString stringWithFormat:@"%lu", (unsigned long)[self.uploads count] + 1];
+        self.uploads[identifier] = [NSMutableData data];
+        return [NetworkStubResponse responseWithStatusCode:201 headerFields:@{@"Location": [@"/files/" stringByAppendingString:identifier]} data:nil];
+    }
+
+    NSMutableData *upload = self.forgetsUploads ? nil : self.uploads[[request.URL lastPathComponent]];
+    if (!upload)
+        return [NetworkStubResponse responseWithStatusCode:404 headerFields:nil data:nil];
+
+    NSDictionary *offsetHeader = @{@"Upload-Offset": [@([upload length]) stringValue]};
+
+    if ([request.HTTPMethod isEqualToString:@"HEAD"])
+        return [NetworkStubResponse responseWithStatusCode:200 headerFields:offsetHeader data:nil];
+
+    if ([request.HTTPMethod isEqualToString:@"PATCH"]) {
+        int64_t offset = [[request valueForHTTPHeaderField:@"Upload-Offset"] longLongValue];
+
+        if (offset != (int64_t)[upload length]) {
+            self.conflictCount++;
+            return [NetworkStubResponse responseWithStatusCode:409 headerFields:offsetHeader data:nil];
+        }
+
+        if (offset == self.failPatchAtOffset) {
+            self.failPatchAtOffset = -1;
+            return [NetworkStubResponse responseWithStatusCode:500 headerFields:nil data:nil];
+        }
+
+        if ([body length] == 0 || (NSInteger)[body length] != [[request valueForHTTPHeaderField:@"Content-Length"] integerValue])
+            return [NetworkStubResponse responseWithStatusCode:400 headerFields:nil data:nil];
+
+        if (offset == self.interruptPatchAtOffset) {
+            self.interruptPatchAtOffset = -1;
+            [upload appendData:[body subdataWithRange:NSMakeRange(0, MIN(self.interruptedPatchBytesKept, [body length]))]];
+            return [NetworkStubResponse responseWithError:[NSError errorWithDomain:NSURLErrorDomain code:NSURLErrorNetworkConnectionLost userInfo:nil]];
+        }
+
+        [upload appendData:body];
+        return [NetworkStubResponse responseWithStatusCode:204 headerFields:@{@"Upload-Offset": [@([upload length]) stringValue]} data:nil];
+    }
+
+    return [NetworkStubResponse responseWithStatusCode:405 headerFields:nil data:nil];
+}
+
+@end
+
+
+@interface NetworkResumableUploadTests : XCTestCase
+
+@property (nonatomic, strong) NetworkManager *manager;
+@property (nonatomic, strong) NetworkTusStandInServer *server;
+@property (nonatomic, strong) NSURL *fileURL;
+@property (nonatomic, strong) NSData *fileData;
+
+@end
+
+@implementation NetworkResumableUploadTests
+
+- (void)setUp {
+    [super setUp];
+
+    self.server = [[NetworkTusStandInServer alloc] init];
+
+    NetworkTusStandInServer *server = self.server;
+    [NetworkStubURLProtocol reset];
+    [NetworkStubURLProtocol setResponseProvider:^NetworkStubResponse *(NSURLRequest *request, NSData *body) {
+        return [server responseForRequest:request body:body];
+    }];
+
+    self.manager = [[NetworkManager alloc] initWithSessionConfiguration:[NetworkStubURLProtocol sessionConfiguration]];
+
+    NSMutableData *data = [NSMutableData dataWithLength:10 * 1024 + 100];
+    for (NSUInteger i = 0; i < [data length]; i++) {
+        ((uint8_t *)[data mutableBytes])[i] = (uint8_t)(i * 7);
+    }
+    self.fileData = data;
+    self.fileURL = [[NSURL fileURLWithPath:NSTemporaryDirectory()] URLByAppendingPathComponent:[[NSUUID UUID] UUIDString]];
+    [self.fileData writeToURL:self.fileURL atomically:YES];
+}
+
+- (void)tearDown {
+    [[self.manager networkQueue] cancelAllOperations];
+    [[self operationWithChunkSize:1024 completion:nil] discardSavedProgress];
+    [[NSFileManager defaultManager] removeItemAtURL:self.fileURL error:nil];
+    [NetworkStubURLProtocol reset];
+
+    [super tearDown];
+}
+
+- (NetworkResumableUploadTaskOperation *)operationWithChunkSize:(int64_t)chunkSize completion:(DidCompleteWithDataErrorHandler)completion {
+    NetworkResumableUploadTaskOperation *operation = [self.manager resumableUploadOperationWithURL:[NSURL URLWithString:@"http://tus.test/files"] fileURL:self.fileURL didSendBodyDataHandler:nil didCompleteWithDataErrorHandler:completion];
+    operation.chunkSize = chunkSize;
+    return operation;
+}
+
+- (NSError *)uploadWithChunkSize:(int64_t)chunkSize {
+    XCTestExpectation *expectation = [self expectationWithDescription:@"complete"];
+    __block NSError *uploadError;
+
+    NetworkResumableUploadTaskOperation *operation = [self operationWithChunkSize:chunkSize completion:^(NetworkTaskOperation *operation, NSData *data, NSError *error) {
+        uploadError = error;
+        [expectation fulfill];
+    }];
+
+    [self.manager addOperation:operation];
+    [self waitForExpectationsWithTimeout:10 handler:nil];
+
+    return uploadError;
+}
+
+- (void)assertServerHasFileData {
+    NSData *upload = self.server.uploads[@"1"];
+
+    XCTAssertEqual([upload length], [self.fileData length]);
+    XCTAssertEqualObjects(upload, self.fileData);
+}
+
+#pragma mark - Tests
+
+- (void)testUploadsSequentiallyToCoreTusServer {
+    NSError *error = [self uploadWithChunkSize:1024];
+
+    XCTAssertNil(error);
+    XCTAssertEqual(self.server.conflictCount, 0u);
+    [self assertServerHasFileData];
+    XCTAssertEqual([NetworkStubURLProtocol maximumRequestsInFlight], 1u);
+    XCTAssertEqualObjects([self.server.methods firstObject], @"POST");
+    XCTAssertEqual([self.server.methods count], 1u + 11u);
+}
+
+- (void)testResumesFromServerOffset {
+    self.server.failPatchAtOffset = 4 * 1024;
+
+    NSError *error = [self uploadWithChunkSize:1024];
+    XCTAssertNotNil(error);
+    XCTAssertEqual([self.server.uploads[@"1"] length], 4u * 1024u);
+
+    // a new operation for the same URL and file asks the server where it left off, rather than starting over
+
+    [self.server.methods removeAllObjects];
+    error = [self uploadWithChunkSize:1024];
+
+    XCTAssertNil(error);
+    XCTAssertEqualObjects([self.server.methods firstObject], @"HEAD");
+    XCTAssertFalse([self.server.methods containsObject:@"POST"]);
+    XCTAssertEqual([self.server.methods count], 1u + 7u);
+    [self assertServerHasFileData];
+}
+
+- (void)testResumesFromOffsetInMiddleOfChunk {
+    self.server.interruptPatchAtOffset = 3 * 1024;
+    self.server.interruptedPatchBytesKept = 300;
+
+    NSError *error = [self uploadWithChunkSize:1024];
+    XCTAssertNotNil(error);
+    XCTAssertEqual([self.server.uploads[@"1"] length], 3u * 1024u + 300u);
+
+    // the first `PATCH` sends only the rest of the interrupted chunk, and the server never sees a conflict
+
+    [self.server.methods removeAllObjects];
+    error = [self uploadWithChunkSize:1024];
+
+    XCTAssertNil(error);
+    XCTAssertEqual(self.server.conflictCount, 0u);
+    XCTAssertEqual([self.server.methods count], 1u + 1u + 7u);
+    [self assertServerHasFileData];
+}
+
+- (void)testServerOffsetOverridesSavedProgress {
+    self.server.failPatchAtOffset = 6 * 1024;
+    XCTAssertNotNil([self uploadWithChunkSize:1024]);
+
+    // the saved progress says six chunks are done, but the server has since lost some of them
+
+    NSMutableData *upload = self.server.uploads[@"1"];
+    [upload setLength:2 * 1024 + 10];
+
+    [self.server.methods removeAllObjects];
+    NSError *error = [self uploadWithChunkSize:1024];
+
+    XCTAssertNil(error);
+    XCTAssertEqual(self.server.conflictCount, 0u);
+    XCTAssertEqual([self.server.methods count], 1u + 1u + 8u);
+    [self assertServerHasFileData];
+}
+
+- (void)testStartsOverWhenServerForgetsUpload {
+    self.server.failPatchAtOffset = 2 * 1024;
+    XCTAssertNotNil([self uploadWithChunkSize:1024]);
+
+    self.server.forgetsUploads = YES;
+    [self.server.methods removeAllObjects];
+    NSError *error = [self uploadWithChunkSize:1024];
+
+    // after the 404, the upload is created again (as upload "2"), though this server then forgets that one too
+
+    XCTAssertNotNil(error);
+    XCTAssertEqualObjects([self.server.methods subarrayWithRange:NSMakeRange(0, 2)], (@[@"HEAD", @"POST"]));
+}
+
+@end
@@ -0,0 +1,83 @@
+//
+//  NetworkStubURLProtocol.h
+//  NetworkManagerTests
+//
+//  Created by agent on 10/19/26.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+/** The canned response returned by `<NetworkStubURLProtocol>` for a request.
+ */
+@interface NetworkStubResponse : NSObject
+
+/// The HTTP status code. Default is 200.
+
+@property (nonatomic) NSInteger statusCode;
+
+/// The HTTP header fields of the response.
+
+@property (nonatomic, copy) NSDictionary *headerFields;
+
+/// The body of the response.
+
+@property (nonatomic, copy) NSData *data;
+
+/// If not `nil`, the request fails with this error rather than returning a response.
+
+@property (nonatomic, strong) NSError *error;
+
+/// The number of seconds to wait before responding. Default is zero.
+
+@property (nonatomic) NSTimeInterval delay;
+
+/// If greater than zero, the body is delivered in chunks of this many bytes. Default is zero (all at once).
+
+@property (nonatomic) NSUInteger chunkSize;
+
+/// The number of seconds to wait between chunks. Default is zero.
+
+@property (nonatomic) NSTimeInterval chunkInterval;
+
++ (instancetype)responseWithStatusCode:(NSInteger)statusCode headerFields:(NSDictionary *)headerFields data:(NSData *)data;
+
++ (instancetype)responseWithError:(NSError *)error;
+
+@end
+
+typedef NetworkStubResponse *(^NetworkStubResponseProvider)(NSURLRequest *request, NSData *body);
+
+/** A local stand-in server, so that tests can exercise `NetworkManager` without the network.
+
+ Create the `NetworkManager` with `<sessionConfiguration>`, and every request made by it is answered by the
+ `<responseProvider>`, which is called on a private serial queue with the request and its body (which
+ `NSURLSession` moves to `HTTPBodyStream` before the protocol sees it).
+ */
+@interface NetworkStubURLProtocol : NSURLProtocol
+
+/// A session configuration whose requests are all handled by this protocol.
+
++ (NSURLSessionConfiguration *)sessionConfiguration;
+
+/// Set the block that answers requests. If it is `nil` (or returns `nil`), requests get an empty 404.
+
++ (void)setResponseProvider:(NetworkStubResponseProvider)responseProvider;
+
+/// The number of requests received since the last `reset`.
+
++ (NSUInteger)requestCount;
+
+/// The number of requests that have been received but not yet answered (or canceled).
+
++ (NSUInteger)requestsInFlight;
+
+/// The greatest value of `<requestsInFlight>` since the last `reset`.
+
++ (NSUInteger)maximumRequestsInFlight;
+
+/// Clear the response provider and the counts.
+
++ (void)reset;
+
+@end
@@ -0,0 +1,241 @@
+//
+//  NetworkStubURLProtocol.m
+//  NetworkManagerTests
+//
+//  Created by agent on 10/19/26.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+
+#import "NetworkStubURLProtocol.h"
+
+static NetworkStubResponseProvider _responseProvider;
+static NSUInteger _requestCount;
+static NSUInteger _requestsInFlight;
+static NSUInteger _maximumRequestsInFlight;
+static dispatch_queue_t _stubQueue;
+
+@implementation NetworkStubResponse
+
++ (instancetype)responseWithStatusCode:(NSInteger)statusCode headerFields:(NSDictionary *)headerFields data:(NSData *)data {
+    NetworkStubResponse *response = [[self alloc] init];
+    response.statusCode = statusCode;
+    response.headerFields = headerFields;
+    response.data = data;
+    return response;
+}
+
++ (instancetype)responseWithError:(NSError *)error {
+    NetworkStubResponse *response = [[self alloc] init];
+    response.error = error;
+    return response;
+}
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        _statusCode = 200;
+    }
+    return self;
+}
+
+@end
+
+@interface NetworkStubURLProtocol ()
+
+@property (nonatomic, strong) NSThread *clientThread;
+@property (nonatomic, copy) NSArray *runLoopModes;
+@property (atomic, getter = isStopped) BOOL stopped;
+@property (atomic, getter = isCounted) BOOL counted;
+
+@end
+
+@implementation NetworkStubURLProtocol
+
++ (void)initialize {
+    if (self == [NetworkStubURLProtocol class]) {
+        _stubQueue = dispatch_queue_create("NetworkStubURLProtocol", DISPATCH_QUEUE_SERIAL);
+    }
+}
+
++ (NSURLSessionConfiguration *)sessionConfiguration {
+    NSURLSessionConfiguration *configuration = [NSURLSessionConfiguration ephemeralSessionConfiguration];
+    configuration.protocolClasses = @[self];
+    configuration.HTTPMaximumConnectionsPerHost = 16;
+    return configuration;
+}
+
++ (void)setResponseProvider:(NetworkStubResponseProvider)responseProvider {
+    dispatch_sync(_stubQueue, ^{
+        _responseProvider = [responseProvider copy];
+    });
+}
+
++ (NSUInteger)requestCount {
+    __block NSUInteger count;
+    dispatch_sync(_stubQueue, ^{
+        count = _requestCount;
+    });
+    return count;
+}
+
++ (NSUInteger)requestsInFlight {
+    __block NSUInteger count;
+    dispatch_sync(_stubQueue, ^{
+        count = _requestsInFlight;
+    });
+    return count;
+}
+
++ (NSUInteger)maximumRequestsInFlight {
+    __block NSUInteger count;
+    dispatch_sync(_stubQueue, ^{
+        count = _maximumRequestsInFlight;
+    });
+    return count;
+}
+
++ (void)reset {
+    dispatch_sync(_stubQueue, ^{
+        _responseProvider = nil;
+        _requestCount = 0;
+        _requestsInFlight = 0;
+        _maximumRequestsInFlight = 0;
+    });
+}
+
+#pragma mark - NSURLProtocol
+
++ (BOOL)canInitWithRequest:(NSURLRequest *)request {
+    return YES;
+}
+
++ (NSURLRequest *)canonicalRequestForRequest:(NSURLRequest *)request {
+    return request;
+}
+
+- (void)startLoading {
+    self.clientThread = [NSThread currentThread];
+    self.runLoopModes = @[[[NSRunLoop currentRunLoop] currentMode] ?: NSDefaultRunLoopMode];
+
+    NSData *body = [self bodyOfRequest:self.request];
+    __block NetworkStubResponse *response;
+
+    dispatch_sync(_stubQueue, ^{
+        _requestCount++;
+        _requestsInFlight++;
+        _maximumRequestsInFlight = MAX(_maximumRequestsInFlight, _requestsInFlight);
+        response = _responseProvider ? _responseProvider(self.request, body) : nil;
+    });
+    self.counted = YES;
+
+    if (!response)
+        response = [NetworkStubResponse responseWithStatusCode:404 headerFields:nil data:[NSData data]];
+
+    [self deliverResponse:response];
+}
+
+- (void)stopLoading {
+    self.stopped = YES;
+    [self finishRequest];
+}
+
+#pragma mark - Private methods
+
+- (NSData *)bodyOfRequest:(NSURLRequest *)request {
+    if (request.HTTPBody)
+        return request.HTTPBody;
+
+    NSInputStream *stream = request.HTTPBodyStream;
+    if (!stream)
+        return nil;
+
+    NSMutableData *body = [NSMutableData data];
+    uint8_t buffer[16384];
+
+    [stream open];
+    NSInteger length;
+    while ((length = [stream read:buffer maxLength:sizeof(buffer)]) > 0) {
+        [body appendBytes:buffer length:length];
+    }
+    [stream close];
+
+    return body;
+}
+
+- (void)finishRequest {
+    if (!self.counted)
+        return;
+    self.counted = NO;
+
+    dispatch_sync(_stubQueue, ^{
+        if (_requestsInFlight > 0)
+            _requestsInFlight--;
+    });
+}
+
+/* Perform the steps in order, each after its delay, on the thread on which the protocol was started (as
+ * `NSURLProtocol` requires), stopping if the load is stopped.
+ */
+- (void)performSteps:(NSArray *)steps delays:(NSArray *)delays index:(NSUInteger)index {
+    if (index >= [steps count] || [self isStopped])
+        return;
+
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)([delays[index] doubleValue] * NSEC_PER_SEC)), dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+        [self performSelector:@selector(performStep:) onThread:self.clientThread withObject:@[steps, delays, @(index)] waitUntilDone:NO modes:self.runLoopModes];
+    });
+}
+
+- (void)performStep:(NSArray *)arguments {
+    NSArray *steps = arguments[0];
+    NSUInteger index = [arguments[2] unsignedIntegerValue];
+
+    if ([self isStopped])
+        return;
+
+    dispatch_block_t step = steps[index];
+    step();
+
+    [self performSteps:steps delays:arguments[1] index:index + 1];
+}
+
+- (void)deliverResponse:(NetworkStubResponse *)response {
+    NSMutableArray *steps = [NSMutableArray array];
+    NSMutableArray *delays = [NSMutableArray array];
+
+    if (response.error) {
+        [steps addObject:[^{
+            [self finishRequest];
+            [self.client URLProtocol:self didFailWithError:response.error];
+        } copy]];
+        [delays addObject:@(response.delay)];
+        [self performSteps:steps delays:delays index:0];
+        return;
+    }
+
+    NSHTTPURLResponse *httpResponse = [[NSHTTPURLResponse alloc] initWithURL:self.request.URL statusCode:response.statusCode HTTPVersion:@"HTTP/1.1" headerFields:response.headerFields];
+    NSData *data = response.data ?: [NSData data];
+    NSUInteger chunkSize = response.chunkSize > 0 ? response.chunkSize : MAX([data length], 1);
+
+    [steps addObject:[^{
+        [self.client URLProtocol:self didReceiveResponse:httpResponse cacheStoragePolicy:NSURLCacheStorageNotAllowed];
+    } copy]];
+    [delays addObject:@(response.delay)];
+
+    for (NSUInteger offset = 0; offset < [data length]; offset += chunkSize) {
+        NSData *chunk = [data subdataWithRange:NSMakeRange(offset, MIN(chunkSize, [data length] - offset))];
+        [steps addObject:[^{
+            [self.client URLProtocol:self didLoadData:chunk];
+        } copy]];
+        [delays addObject:@(offset == 0 ? 0 : response.chunkInterval)];
+    }
+
+    [steps addObject:[^{
+        [self finishRequest];
+        [self.client URLProtocolDidFinishLoading:self];
+    } copy]];
+    [delays addObject:@0];
+
+    [self performSteps:steps delays:delays index:0];
+}
+
+@end
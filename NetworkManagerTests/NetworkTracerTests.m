@@ -0,0 +1,205 @@
+//
+//  NetworkTracerTests.m
+//  NetworkManagerTests
+//
+//  Created by agent on 10/19/26.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+
+#import <XCTest/XCTest.h>
+#import "NetworkManager.h"
+#import "NetworkStubURLProtocol.h"
+
+@interface NetworkTracerTests : XCTestCase
+
+@property (nonatomic, strong) NetworkManager *manager;
+
+@end
+
+@implementation NetworkTracerTests
+
+- (void)setUp {
+    [super setUp];
+
+    [NetworkStubURLProtocol reset];
+    [NetworkStubURLProtocol setResponseProvider:^NetworkStubResponse *(NSURLRequest *request, NSData *body) {
+        NetworkStubResponse *response = [NetworkStubResponse responseWithStatusCode:200 headerFields:nil data:[NSMutableData dataWithLength:4096]];
+        response.chunkSize = 1024;
+        return response;
+    }];
+
+    self.manager = [[NetworkManager alloc] initWithSessionConfiguration:[NetworkStubURLProtocol sessionConfiguration]];
+}
+
+- (void)tearDown {
+    [[self.manager networkQueue] cancelAllOperations];
+    [NetworkStubURLProtocol reset];
+
+    [super tearDown];
+}
+
+#pragma mark - Helpers
+
+- (NSArray *)traceEventsOfTracer:(NetworkTracer *)tracer {
+    NSDictionary *trace = [NSJSONSerialization JSONObjectWithData:[tracer chromeTraceData] options:0 error:nil];
+    return trace[@"traceEvents"];
+}
+
+- (NSSet *)namesOfTraceEvents:(NSArray *)traceEvents {
+    return [NSSet setWithArray:[traceEvents valueForKey:@"name"]];
+}
+
+- (void)performRequestsWithCount:(NSUInteger)count {
+    XCTestExpectation *expectation = [self expectationWithDescription:@"complete"];
+    __block NSUInteger completed = 0;
+
+    for (NSUInteger i = 0; i < count; i++) {
+        NSURL *url = [NSURL URLWithString:[NSString stringWithFormat:@"http://trace.test/%lu", (unsigned long)i]];
+        NetworkDataTaskOperation *operation = [self.manager dataOperationWithURL:url progressHandler:nil completionHandler:^(NetworkTaskOperation *operation, NSData *data, NSError *error) {
+            XCTAssertNil(error);
+            if (++completed == count)
+                [expectation fulfill];
+        }];
+        [self.manager addOperation:operation];
+    }
+
+    [self waitForExpectationsWithTimeout:10 handler:nil];
+}
+
+#pragma mark - Tests
+
+- (void)testRecordsRequestLifecycle {
+    NetworkTracer *tracer = [[NetworkTracer alloc] init];
+    self.manager.tracer = tracer;
+
+    [self performRequestsWithCount:1];
+
+    NSArray *traceEvents = [self traceEventsOfTracer:tracer];
+    NSSet *names = [self namesOfTraceEvents:traceEvents];
+
+    for (NSString *name in @[@"queued", @"task", @"response", @"accumulateData", @"didComplete"]) {
+        XCTAssertTrue([names containsObject:name], @"missing %@", name);
+    }
+
+    for (NSDictionary *traceEvent in traceEvents) {
+        XCTAssertEqualObjects(traceEvent[@"args"][@"host"], @"trace.test");
+    }
+}
+
+- (void)testTracesDefaultDataDelivery {
+    NetworkTracer *tracer = [[NetworkTracer alloc] init];
+    self.manager.tracer = tracer;
+
+    [self performRequestsWithCount:1];
+
+    // without a `didReceiveData` handler, each chunk is accumulated on the delegate queue, and that is what is traced
+
+    int64_t bytes = 0;
+    for (NSDictionary *traceEvent in [self traceEventsOfTracer:tracer]) {
+        if ([traceEvent[@"name"] isEqualToString:@"accumulateData"]) {
+            XCTAssertEqualObjects(traceEvent[@"cat"], @"data");
+            bytes += [traceEvent[@"args"][@"bytes"] longLongValue];
+        }
+    }
+    XCTAssertEqual(bytes, 4096);
+}
+
+- (void)testRingBufferKeepsMostRecentEvents {
+    NetworkTracer *tracer = [[NetworkTracer alloc] initWithCapacity:4];
+
+    for (int64_t i = 0; i < 10; i++) {
+        [tracer recordInstantNamed:"event" category:"test" task:nil bytes:i];
+    }
+
+    NSArray *bytes = [[self traceEventsOfTracer:tracer] valueForKeyPath:@"args.bytes"];
+    XCTAssertEqualObjects(bytes, (@[@6, @7, @8, @9]));
+}
+
+- (void)testResetDiscardsEarlierEvents {
+    NetworkTracer *tracer = [[NetworkTracer alloc] initWithCapacity:8];
+
+    for (int64_t i = 0; i < 5; i++) {
+        [tracer recordInstantNamed:"before" category:"test" task:nil bytes:i];
+    }
+    [tracer reset];
+    XCTAssertEqual([[self traceEventsOfTracer:tracer] count], 0u);
+
+    [tracer recordInstantNamed:"after" category:"test" task:nil bytes:0];
+    XCTAssertEqualObjects([self namesOfTraceEvents:[self traceEventsOfTracer:tracer]], [NSSet setWithObject:@"after"]);
+}
+
+- (void)testResetWhileRecording {
+    NetworkTracer *tracer = [[NetworkTracer alloc] initWithCapacity:256];
+    dispatch_queue_t queue = dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0);
+    dispatch_group_t group = dispatch_group_create();
+
+    // writers, readers, and resets all at once; every exported event must be intact
+
+    dispatch_group_async(group, queue, ^{
+        dispatch_apply(8, queue, ^(size_t iteration) {
+            for (int64_t i = 0; i < 20000; i++) {
+                [tracer recordSpanNamed:"span" category:"test" start:1 end:2 task:nil bytes:i];
+            }
+        });
+    });
+
+    for (NSUInteger i = 0; i < 50; i++) {
+        [tracer reset];
+        for (NSDictionary *traceEvent in [self traceEventsOfTracer:tracer]) {
+            XCTAssertEqualObjects(traceEvent[@"name"], @"span");
+            XCTAssertEqualObjects(traceEvent[@"cat"], @"test");
+        }
+    }
+
+    XCTAssertEqual(dispatch_group_wait(group, dispatch_time(DISPATCH_TIME_NOW, 30 * NSEC_PER_SEC)), 0);
+
+    [tracer reset];
+    [tracer recordInstantNamed:"last" category:"test" task:nil bytes:-1];
+    XCTAssertEqual([[self traceEventsOfTracer:tracer] count], 1u);
+}
+
+- (void)testWritesChromeTrace {
+    NetworkTracer *tracer = [[NetworkTracer alloc] init];
+    [tracer recordSpanNamed:"span" category:"test" start:NetworkTracerNow() end:NetworkTracerNow() task:nil bytes:-1];
+
+    NSURL *url = [[NSURL fileURLWithPath:NSTemporaryDirectory()] URLByAppendingPathComponent:[[NSUUID UUID] UUIDString]];
+    NSError *error;
+    XCTAssertTrue([tracer writeChromeTraceToURL:url error:&error], @"%@", error);
+
+    NSDictionary *trace = [NSJSONSerialization JSONObjectWithData:[NSData dataWithContentsOfURL:url] options:0 error:nil];
+    NSDictionary *traceEvent = [trace[@"traceEvents"] firstObject];
+    XCTAssertEqualObjects(traceEvent[@"ph"], @"X");
+    XCTAssertNotNil(traceEvent[@"dur"]);
+
+    [[NSFileManager defaultManager] removeItemAtURL:url error:nil];
+}
+
+#pragma mark - Overhead
+
+// compare these two to see what tracing costs a request end to end
+
+- (void)testPerformanceRequestsWithoutTracer {
+    [self measureBlock:^{
+        [self performRequestsWithCount:20];
+    }];
+}
+
+- (void)testPerformanceRequestsWithTracer {
+    self.manager.tracer = [[NetworkTracer alloc] init];
+
+    [self measureBlock:^{
+        [self performRequestsWithCount:20];
+    }];
+}
+
+- (void)testPerformanceRecordSpan {
+    NetworkTracer *tracer = [[NetworkTracer alloc] init];
+
+    [self measureBlock:^{
+        for (NSUInteger i = 0; i < 100000; i++) {
+            [tracer recordSpanNamed:"span" category:"test" start:1 end:2 task:nil bytes:-1];
+        }
+    }];
+}
+
+@end